@@ -1,7 +1,13 @@
 #include "big_int.h"
+#include "budget.h"
+#include "tuning.h"
+#include "divisor.h"
+#include "natural.h"
+#include "ntt.h"
 #include <stdexcept>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 
@@ -57,6 +63,57 @@ void BigInt::read(const std::string& str) {
     trim();
 }
 
+/*
+    A serialized record is a little-endian 32-bit header holding the number of limbs in the low 31
+    bits and the sign in the top bit, followed by the base-10^9 limbs as little-endian 32-bit
+    words. Records stay 4-byte aligned, so MappedBigIntArray can expose them without copying.
+*/
+
+namespace {
+
+uint32_t loadLittleEndian32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+}  // namespace
+
+void BigInt::appendRecord(const BigInt& number, std::string* out) {
+    auto append_word = [out](uint32_t word) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            out->push_back(static_cast<char>((word >> shift) & 0xFF));
+        }
+    };
+    append_word(static_cast<uint32_t>(number.digits_.size()) |
+                (number.sign_ == -1 ? 0x80000000u : 0));
+    for (int digit : number.digits_) {
+        append_word(static_cast<uint32_t>(digit));
+    }
+}
+
+BigInt BigInt::readRecord(const unsigned char* data, std::size_t size) {
+    if (size < 4) {
+        throw std::invalid_argument("Malformed serialized BigInt");
+    }
+    const uint32_t header = loadLittleEndian32(data);
+    const std::size_t count = header & 0x7FFFFFFFu;
+    if ((size - 4) / 4 < count) {
+        throw std::invalid_argument("Malformed serialized BigInt");
+    }
+    BigInt result;
+    result.digits_.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const uint32_t digit = loadLittleEndian32(data + 4 * (i + 1));
+        if (digit >= static_cast<uint32_t>(kBase)) {
+            throw std::invalid_argument("Malformed serialized BigInt");
+        }
+        result.digits_[i] = static_cast<int>(digit);
+    }
+    result.sign_ = (header >> 31) ? -1 : 1;
+    result.trim();
+    return result;
+}
+
 std::vector<int> BigInt::convertBase(const std::vector<int>& digits, int old_digits,
                                      int new_digits) {
     std::vector<int64_t> p(std::max(old_digits, new_digits) + 1);
@@ -87,7 +144,7 @@ std::vector<int64_t> BigInt::karatsubaMultiply(const std::vector<int64_t>& a,
                                                const std::vector<int64_t>& b) {
     int n = a.size();
     std::vector<int64_t> res(n + n);
-    if (n <= 32) {
+    if (n <= TuningProfile::active().karatsuba_base_case) {
         for (int i = 0; i < n; ++i) {
             for (int j = 0; j < n; ++j) {
                 res[i + j] += a[i] * b[j];
@@ -96,6 +153,8 @@ std::vector<int64_t> BigInt::karatsubaMultiply(const std::vector<int64_t>& a,
         return res;
     }
 
+    BudgetScope::checkpoint();
+
     int k = n >> 1;
     std::vector<int64_t> a1(a.begin(), a.begin() + k);
     std::vector<int64_t> a2(a.begin() + k, a.end());
@@ -139,9 +198,21 @@ BigInt BigInt::abs() const {
 }
 
 std::pair<BigInt, BigInt> divmod(const BigInt& a1, const BigInt& b1) {
+    if (b1.digits_.empty()) {
+        throw std::domain_error("Division by zero");
+    }
     if (a1.digits_.empty()) {
         return {0, 0};
     }
+    const TuningProfile& tuning = TuningProfile::active();
+    const int64_t dividend_limbs = a1.digits_.size();
+    const int64_t divisor_limbs = b1.digits_.size();
+    if (dividend_limbs < tuning.binary_division_limbs ||
+        dividend_limbs <= tuning.binary_division_ratio * divisor_limbs) {
+        natural::Limbs q, r;
+        natural::divmod(BigIntAccess::magnitude(a1), BigIntAccess::magnitude(b1), &q, &r);
+        return {BigIntAccess::make(q, a1.sign_ * b1.sign_), BigIntAccess::make(r, a1.sign_)};
+    }
     int norm = a1.kBase / (b1.digits_.back() + 1);
     BigInt a = a1.abs() * norm;
     BigInt b = b1.abs() * norm;
@@ -149,6 +220,9 @@ std::pair<BigInt, BigInt> divmod(const BigInt& a1, const BigInt& b1) {
     q.digits_.resize(a.digits_.size());
 
     for (int i = static_cast<int>(a.digits_.size()) - 1; i >= 0; --i) {
+        if (i % 64 == 0) {
+            BudgetScope::checkpoint();
+        }
         r *= a1.kBase;
         r += a.digits_[i];
         int s1 = r.digits_.size() <= b.digits_.size() ? 0 : r.digits_[b.digits_.size()];
@@ -169,6 +243,156 @@ std::pair<BigInt, BigInt> divmod(const BigInt& a1, const BigInt& b1) {
     return std::make_pair(q, r / norm);
 }
 
+/*
+    Fused multiply-accumulate
+*/
+
+namespace {
+
+// Base-10^9 columns whose carries are propagated lazily. A row adds at most (10^9 - 1)^2 to a
+// column, so a normalised column can take 17 rows before it may overflow 64 bits.
+class ColumnAccumulator {
+public:
+    void addRow(const int* digits, std::size_t size, uint64_t factor, std::size_t shift) {
+        if (pending_ == kMaxPendingRows) {
+            normalize();
+        }
+        if (columns_.size() < shift + size) {
+            columns_.resize(shift + size);
+        }
+        for (std::size_t j = 0; j < size; ++j) {
+            columns_[shift + j] += factor * static_cast<uint64_t>(digits[j]);
+        }
+        ++pending_;
+    }
+
+    std::vector<int> release() {
+        normalize();
+        std::vector<int> digits(columns_.begin(), columns_.end());
+        while (!digits.empty() && !digits.back()) {
+            digits.pop_back();
+        }
+        return digits;
+    }
+
+private:
+    static const int kMaxPendingRows = 17;
+    static const uint64_t kBase = 1000000000;
+
+    std::vector<uint64_t> columns_;
+    int pending_ = 0;
+
+    void normalize() {
+        uint64_t carry = 0;
+        for (uint64_t& column : columns_) {
+            column += carry;
+            carry = column / kBase;
+            column %= kBase;
+        }
+        for (; carry > 0; carry /= kBase) {
+            columns_.push_back(carry % kBase);
+        }
+        pending_ = 0;
+    }
+};
+
+}  // namespace
+
+// Returns initial + direction * sum(a[i] * b[i]) with direction = +1 or -1.
+BigInt BigInt::accumulateProducts(const BigInt& initial, const BigInt* a, const BigInt* b,
+                                  std::size_t count, int direction) {
+    ColumnAccumulator positive;
+    ColumnAccumulator negative;
+    (initial.sign_ == 1 ? positive : negative)
+        .addRow(initial.digits_.data(), initial.digits_.size(), 1, 0);
+
+    for (std::size_t k = 0; k < count; ++k) {
+        const BigInt& x = a[k].digits_.size() >= b[k].digits_.size() ? a[k] : b[k];
+        const BigInt& y = &x == &a[k] ? b[k] : a[k];
+        ColumnAccumulator& target = a[k].sign_ * b[k].sign_ == direction ? positive : negative;
+        if (static_cast<int>(y.digits_.size()) >= TuningProfile::active().schoolbook_limbs ||
+            multipliesByNtt(y.digits_.size(), x.digits_.size())) {
+            const BigInt product = x * y;
+            target.addRow(product.digits_.data(), product.digits_.size(), 1, 0);
+            continue;
+        }
+        for (std::size_t i = 0; i < y.digits_.size(); ++i) {
+            target.addRow(x.digits_.data(), x.digits_.size(), y.digits_[i], i);
+        }
+    }
+
+    BigInt plus, minus;
+    plus.digits_ = positive.release();
+    minus.digits_ = negative.release();
+    return plus - minus;
+}
+
+void addmul(BigInt* acc, const BigInt& a, const BigInt& b) {
+    *acc = BigInt::accumulateProducts(*acc, &a, &b, 1, 1);
+}
+
+void submul(BigInt* acc, const BigInt& a, const BigInt& b) {
+    *acc = BigInt::accumulateProducts(*acc, &a, &b, 1, -1);
+}
+
+BigInt dot(const std::vector<BigInt>& a, const std::vector<BigInt>& b) {
+    if (a.size() != b.size()) {
+        throw std::invalid_argument("dot: operands have different lengths");
+    }
+    return BigInt::accumulateProducts(BigInt(), a.data(), b.data(), a.size(), 1);
+}
+
+/*
+    Exponentiation
+*/
+
+BigInt pow(const BigInt& base, uint64_t exponent) {
+    int bits = 0;
+    while (bits < 64 && (exponent >> bits)) {
+        ++bits;
+    }
+    if (bits == 0) {
+        return 1;
+    }
+    const int window = bits > 24 ? 4 : bits > 8 ? 3 : 1;
+
+    // table[i] = base^(2 i + 1)
+    std::vector<BigInt> table(std::size_t(1) << (window - 1));
+    table[0] = base;
+    if (table.size() > 1) {
+        const BigInt square = base * base;
+        for (std::size_t i = 1; i < table.size(); ++i) {
+            table[i] = table[i - 1] * square;
+        }
+    }
+
+    BigInt result = 1;
+    bool started = false;
+    for (int i = bits - 1; i >= 0;) {
+        if (!((exponent >> i) & 1)) {
+            result = result * result;
+            --i;
+            continue;
+        }
+        int low = std::max(i - window + 1, 0);
+        while (!((exponent >> low) & 1)) {
+            ++low;
+        }
+        const uint64_t value = (exponent >> low) & ((uint64_t(1) << (i - low + 1)) - 1);
+        if (started) {
+            for (int j = low; j <= i; ++j) {
+                result = result * result;
+            }
+            result = result * table[value >> 1];
+        } else {
+            result = table[value >> 1];
+            started = true;
+        }
+        i = low - 1;
+    }
+    return result;
+}
+
 /*
     Constructors
 */
@@ -307,11 +531,11 @@ BigInt& BigInt::operator*=(int64_t value) {
 }
 
 BigInt& BigInt::operator/=(int64_t value) {
-    return *this = (*this / BigInt(value));
+    return *this = (*this / value);
 }
 
 BigInt& BigInt::operator%=(int64_t value) {
-    return *this = (*this % BigInt(value));
+    return *this = (*this % value);
 }
 
 /*
@@ -323,15 +547,17 @@ BigInt BigInt::operator+(const BigInt& number) const {
         return *this - (-number);
     }
     BigInt result = number;
+    const std::vector<int>& digits = digits_;
+    std::vector<int>& sum = result.digits_.mutate();
     for (int i = 0, carry = 0;
-         i < static_cast<int>(std::max(digits_.size(), number.digits_.size())) || carry; ++i) {
-        if (i == static_cast<int>(result.digits_.size())) {
-            result.digits_.push_back(0);
+         i < static_cast<int>(std::max(digits.size(), number.digits_.size())) || carry; ++i) {
+        if (i == static_cast<int>(sum.size())) {
+            sum.push_back(0);
         }
-        result.digits_[i] += carry + (i < static_cast<int>(digits_.size()) ? digits_[i] : 0);
-        carry = result.digits_[i] >= kBase;
+        sum[i] += carry + (i < static_cast<int>(digits.size()) ? digits[i] : 0);
+        carry = sum[i] >= kBase;
         if (carry) {
-            result.digits_[i] -= kBase;
+            sum[i] -= kBase;
         }
     }
     return result;
@@ -343,12 +569,14 @@ BigInt BigInt::operator-(const BigInt& number) const {
     }
     if (abs() >= number.abs()) {
         BigInt result = *this;
-        for (int i = 0, carry = 0; i < static_cast<int>(number.digits_.size()) || carry; ++i) {
-            result.digits_[i] -=
-                carry + (i < static_cast<int>(number.digits_.size()) ? number.digits_[i] : 0);
-            carry = result.digits_[i] < 0;
+        const std::vector<int>& subtrahend = number.digits_;
+        std::vector<int>& difference = result.digits_.mutate();
+        for (int i = 0, carry = 0; i < static_cast<int>(subtrahend.size()) || carry; ++i) {
+            difference[i] -=
+                carry + (i < static_cast<int>(subtrahend.size()) ? subtrahend[i] : 0);
+            carry = difference[i] < 0;
             if (carry) {
-                result.digits_[i] += kBase;
+                difference[i] += kBase;
             }
         }
         result.trim();
@@ -357,7 +585,29 @@ BigInt BigInt::operator-(const BigInt& number) const {
     return -(number - *this);
 }
 
+// Whether operator* uses number-theoretic transforms. They are checked first: for a shorter
+// operand below schoolbook_limbs but long enough for the transforms, schoolbook grows with the
+// product of the lengths and the transforms with their sum.
+bool BigInt::multipliesByNtt(std::size_t shorter, std::size_t longer) {
+    const TuningProfile& tuning = TuningProfile::active();
+    return static_cast<int64_t>(longer) >= tuning.ntt_limbs &&
+           static_cast<int64_t>(shorter) >= tuning.ntt_min_limbs && shorter <= ntt::kMaxFactorLimbs;
+}
+
 BigInt BigInt::operator*(const BigInt& number) const {
+    const TuningProfile& tuning = TuningProfile::active();
+    const std::size_t shorter = std::min(digits_.size(), number.digits_.size());
+    const std::size_t longer = std::max(digits_.size(), number.digits_.size());
+    if (multipliesByNtt(shorter, longer)) {
+        BigInt result;
+        result.sign_ = sign_ * number.sign_;
+        result.digits_ = ntt::multiply(digits_, number.digits_);
+        result.trim();
+        return result;
+    }
+    if (static_cast<int>(shorter) < tuning.schoolbook_limbs) {
+        return accumulateProducts(BigInt(), this, &number, 1, 1);
+    }
     std::vector<int> a6 = convertBase(digits_, kBaseDigits, 6);
     std::vector<int> b6 = convertBase(number.digits_, kBaseDigits, 6);
     std::vector<int64_t> a(a6.begin(), a6.end());
@@ -375,13 +625,15 @@ BigInt BigInt::operator*(const BigInt& number) const {
     std::vector<int64_t> multiply = karatsubaMultiply(a, b);
     BigInt result;
     result.sign_ = sign_ * number.sign_;
-    int carry = 0;
+    std::vector<int> digits6;
+    digits6.reserve(multiply.size());
+    int64_t carry = 0;
     for (int64_t multiply_digit : multiply) {
         int64_t cur = multiply_digit + carry;
-        result.digits_.push_back(static_cast<int>(cur % 1000000));
-        carry = static_cast<int>(cur / 1000000);
+        digits6.push_back(static_cast<int>(cur % 1000000));
+        carry = cur / 1000000;
     }
-    result.digits_ = convertBase(result.digits_, 6, kBaseDigits);
+    result.digits_ = convertBase(digits6, 6, kBaseDigits);
     result.trim();
     return result;
 }
@@ -459,7 +711,7 @@ BigInt operator*(int64_t lhs, const BigInt& rhs) {
 }
 
 BigInt BigInt::operator/(int64_t rhs) const {
-    return *this / BigInt(rhs);
+    return divmod(*this, Divisor(rhs)).first;
 }
 
 BigInt operator/(int64_t lhs, const BigInt& rhs) {
@@ -467,7 +719,7 @@ BigInt operator/(int64_t lhs, const BigInt& rhs) {
 }
 
 BigInt BigInt::operator%(int64_t rhs) const {
-    return *this % BigInt(rhs);
+    return Divisor(rhs).remainder(*this);
 }
 
 BigInt operator%(int64_t lhs, const BigInt& rhs) {
@@ -475,90 +727,392 @@ BigInt operator%(int64_t lhs, const BigInt& rhs) {
 }
 
 /*
-    Relational operators; All operators depend on the '<' operator.
+    Shift and bitwise operators
 */
 
-bool BigInt::operator<(const BigInt& rhs) const {
+namespace {
+
+// -x modulo 2^(32 n) in place.
+void negateLimbs(natural::Limbs* limbs) {
+    uint64_t carry = 1;
+    for (uint32_t& limb : *limbs) {
+        carry += static_cast<uint32_t>(~limb);
+        limb = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+}
+
+// |x| mod 10^(9 count) in binary limbs. 10^(9 i) is a multiple of 2^(9 i), so this agrees with
+// |x| on its lowest 9 count bits, at the cost of converting count limbs instead of all of them.
+natural::Limbs lowBits(const BigInt& x, std::size_t count) {
+    const std::vector<int>& digits = BigIntAccess::digits(x);
+    return natural::fromDecimal(
+        std::vector<int>(digits.begin(), digits.begin() + std::min(count, digits.size())));
+}
+
+// Combines the two's complement forms of a and b limb by limb.
+template <typename Operation>
+BigInt bitwise(const BigInt& a, const BigInt& b, Operation operation) {
+    natural::Limbs x = BigIntAccess::magnitude(a);
+    natural::Limbs y = BigIntAccess::magnitude(b);
+    // One spare limb holds the sign bit.
+    const std::size_t length = std::max(x.size(), y.size()) + 1;
+    x.resize(length);
+    y.resize(length);
+    if (BigIntAccess::sign(a) < 0) {
+        negateLimbs(&x);
+    }
+    if (BigIntAccess::sign(b) < 0) {
+        negateLimbs(&y);
+    }
+    for (std::size_t i = 0; i < length; ++i) {
+        x[i] = operation(x[i], y[i]);
+    }
+    const bool negative = x.back() >> 31;
+    if (negative) {
+        negateLimbs(&x);
+    }
+    natural::normalize(&x);
+    return BigIntAccess::make(x, negative ? -1 : 1);
+}
+
+// base^exponent for the long shifts. Repeated shifts by the same amount reuse the last power.
+template <int base>
+const BigInt& shiftPower(std::size_t exponent) {
+    thread_local std::size_t cached_exponent = 0;
+    thread_local BigInt cached = 1;
+    if (exponent != cached_exponent) {
+        cached = pow(BigInt(base), exponent);
+        cached_exponent = exponent;
+    }
+    return cached;
+}
+
+}  // namespace
+
+BigInt& BigInt::operator<<=(std::size_t bits) {
+    if (digits_.empty() || bits == 0) {
+        return *this;
+    }
+    if (bits > kInPlaceShiftLimit) {
+        return *this *= shiftPower<2>(bits);
+    }
+    while (bits > 0) {
+        const int step = static_cast<int>(std::min<std::size_t>(bits, kShiftStep));
+        int64_t carry = 0;
+        for (int& digit : digits_) {
+            carry += static_cast<int64_t>(digit) << step;
+            digit = static_cast<int>(carry % kBase);
+            carry /= kBase;
+        }
+        if (carry) {
+            digits_.push_back(static_cast<int>(carry));
+        }
+        bits -= step;
+    }
+    return *this;
+}
+
+BigInt& BigInt::operator>>=(std::size_t bits) {
+    if (digits_.empty() || bits == 0) {
+        return *this;
+    }
+    const int sign = sign_;
+    if (bits >= digits_.size() * 30) {  // |x| < 2^(30 n)
+        return *this = BigInt(sign < 0 ? -1 : 0);
+    }
+    bool inexact = false;
+    if (bits > kInPlaceShiftLimit) {
+        // x / 2^k = x * 5^k / 10^k, and dividing by 10^k drops k decimal digits.
+        *this *= shiftPower<5>(bits);
+        std::vector<int>& digits = digits_.mutate();
+        const std::size_t limbs = bits / kBaseDigits;
+        inexact = std::any_of(digits.begin(), digits.begin() + limbs, [](int d) { return d; });
+        digits.erase(digits.begin(), digits.begin() + limbs);
+        int divisor = 1;
+        for (std::size_t i = 0; i < bits % kBaseDigits; ++i) {
+            divisor *= 10;
+        }
+        int64_t remainder = 0;
+        for (std::size_t i = digits.size(); i-- > 0;) {
+            const int64_t current = remainder * kBase + digits[i];
+            digits[i] = static_cast<int>(current / divisor);
+            remainder = current % divisor;
+        }
+        inexact |= remainder != 0;
+    } else {
+        for (; bits > 0; bits -= std::min<std::size_t>(bits, kShiftStep)) {
+            const int step = static_cast<int>(std::min<std::size_t>(bits, kShiftStep));
+            const int64_t mask = (int64_t(1) << step) - 1;
+            std::vector<int>& digits = digits_.mutate();
+            int64_t remainder = 0;
+            for (std::size_t i = digits.size(); i-- > 0;) {
+                const int64_t current = remainder * kBase + digits[i];
+                digits[i] = static_cast<int>(current >> step);
+                remainder = current & mask;
+            }
+            inexact |= remainder != 0;
+        }
+    }
+    trim();
+    if (sign < 0 && inexact) {
+        // Round the magnitude up.
+        std::size_t i = 0;
+        for (; i < digits_.size() && digits_[i] == kBase - 1; ++i) {
+            digits_[i] = 0;
+        }
+        if (i == digits_.size()) {
+            digits_.push_back(1);
+        } else {
+            ++digits_[i];
+        }
+    }
+    sign_ = digits_.empty() ? 1 : sign;
+    return *this;
+}
+
+BigInt& BigInt::operator&=(const BigInt& value) {
+    return *this = (*this & value);
+}
+
+BigInt& BigInt::operator|=(const BigInt& value) {
+    return *this = (*this | value);
+}
+
+BigInt& BigInt::operator^=(const BigInt& value) {
+    return *this = (*this ^ value);
+}
+
+BigInt BigInt::operator<<(std::size_t bits) const {
+    BigInt result = *this;
+    return result <<= bits;
+}
+
+BigInt BigInt::operator>>(std::size_t bits) const {
+    BigInt result = *this;
+    return result >>= bits;
+}
+
+BigInt BigInt::operator&(const BigInt& rhs) const {
+    return bitwise(*this, rhs, [](uint32_t a, uint32_t b) { return a & b; });
+}
+
+BigInt BigInt::operator|(const BigInt& rhs) const {
+    return bitwise(*this, rhs, [](uint32_t a, uint32_t b) { return a | b; });
+}
+
+BigInt BigInt::operator^(const BigInt& rhs) const {
+    return bitwise(*this, rhs, [](uint32_t a, uint32_t b) { return a ^ b; });
+}
+
+BigInt BigInt::operator~() const {
+    return -*this - 1;
+}
+
+std::size_t BigInt::bit_length() const {
+    if (digits_.empty()) {
+        return 0;
+    }
+    // log2 from the top three limbs is exact unless |x| lies very close to a power of two.
+    const std::size_t used = std::min<std::size_t>(digits_.size(), 3);
+    double top = 0;
+    for (std::size_t i = 0; i < used; ++i) {
+        top = top * kBase + digits_[digits_.size() - 1 - i];
+    }
+    const double estimate = std::log2(top) + static_cast<double>(digits_.size() - used) *
+                                                 kBaseDigits * std::log2(10.0);
+    const double whole = std::floor(estimate);
+    if (estimate - whole > 1e-6 && whole + 1 - estimate > 1e-6) {
+        return static_cast<std::size_t>(whole) + 1;
+    }
+    return natural::bitLength(BigIntAccess::magnitude(*this));
+}
+
+bool BigInt::test_bit(std::size_t bit) const {
+    if (bit >= bit_length()) {
+        return sign_ < 0;
+    }
+    // Bits 0..bit of |x| come from the low decimal limbs alone; negated at a width covering the
+    // bit, they give those of the two's complement.
+    natural::Limbs limbs = lowBits(*this, bit / kBaseDigits + 1);
+    limbs.resize(bit / 32 + 1);
+    if (sign_ < 0) {
+        negateLimbs(&limbs);
+    }
+    return (limbs[bit / 32] >> (bit % 32)) & 1;
+}
+
+std::size_t BigInt::trailing_zeros() const {
+    if (digits_.empty()) {
+        return 0;
+    }
+    // The low `count` limbs decide the trailing zeros of x if they have fewer than 9 count of
+    // them; otherwise the window doubles.
+    for (std::size_t count = 1;; count *= 2) {
+        const natural::Limbs limbs = lowBits(*this, count);
+        if (natural::isZero(limbs)) {
+            continue;
+        }
+        std::size_t zeros = 0;
+        std::size_t i = 0;
+        for (; !limbs[i]; ++i) {
+            zeros += 32;
+        }
+        for (uint32_t limb = limbs[i]; !(limb & 1); limb >>= 1) {
+            ++zeros;
+        }
+        if (zeros < count * kBaseDigits || count >= digits_.size()) {
+            return zeros;
+        }
+    }
+}
+
+std::size_t BigInt::popcount() const {
+    std::size_t count = 0;
+    for (uint32_t limb : BigIntAccess::magnitude(*this)) {
+        for (; limb; limb &= limb - 1) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+/*
+    Relational operators; All operators depend on compare(), which scans the limbs once.
+*/
+
+int BigInt::compare(const BigInt& rhs) const {
     if (sign_ != rhs.sign_) {
-        return sign_ == -1;
+        return sign_;
     }
     if (digits_.size() != rhs.digits_.size()) {
-        return digits_.size() * sign_ < rhs.digits_.size() * sign_;
+        return digits_.size() < rhs.digits_.size() ? -sign_ : sign_;
     }
-    for (int i = digits_.size() - 1; i >= 0; --i) {
+    for (int i = static_cast<int>(digits_.size()) - 1; i >= 0; --i) {
         if (digits_[i] != rhs.digits_[i]) {
-            return digits_[i] * sign_ < rhs.digits_[i] * sign_;
+            return digits_[i] < rhs.digits_[i] ? -sign_ : sign_;
+        }
+    }
+    return 0;
+}
+
+int BigInt::compare(int64_t rhs) const {
+    const int rhs_sign = rhs < 0 ? -1 : 1;
+    if (sign_ != rhs_sign) {
+        return sign_;
+    }
+    uint64_t magnitude = rhs < 0 ? ~static_cast<uint64_t>(rhs) + 1 : static_cast<uint64_t>(rhs);
+    int rhs_digits[3] = {};
+    int rhs_size = 0;
+    for (; magnitude > 0; magnitude /= kBase) {
+        rhs_digits[rhs_size++] = static_cast<int>(magnitude % kBase);
+    }
+    if (static_cast<int>(digits_.size()) != rhs_size) {
+        return static_cast<int>(digits_.size()) < rhs_size ? -sign_ : sign_;
+    }
+    for (int i = rhs_size - 1; i >= 0; --i) {
+        if (digits_[i] != rhs_digits[i]) {
+            return digits_[i] < rhs_digits[i] ? -sign_ : sign_;
         }
     }
-    return false;
+    return 0;
+}
+
+#ifdef BIG_INT_HAS_THREE_WAY_COMPARISON
+std::strong_ordering BigInt::operator<=>(const BigInt& rhs) const {
+    return compare(rhs) <=> 0;
+}
+
+std::strong_ordering BigInt::operator<=>(int64_t rhs) const {
+    return compare(rhs) <=> 0;
+}
+#endif
+
+bool BigInt::operator<(const BigInt& rhs) const {
+    return compare(rhs) < 0;
 }
 
 bool BigInt::operator>(const BigInt& rhs) const {
-    return rhs < *this;
+    return compare(rhs) > 0;
 }
 
 bool BigInt::operator<=(const BigInt& rhs) const {
-    return !(rhs < *this);
+    return compare(rhs) <= 0;
 }
 
 bool BigInt::operator>=(const BigInt& rhs) const {
-    return !(*this < rhs);
+    return compare(rhs) >= 0;
 }
 
 bool BigInt::operator==(const BigInt& rhs) const {
-    return !(*this < rhs) && !(rhs < *this);
+    return sign_ == rhs.sign_ && digits_.size() == rhs.digits_.size() &&
+           (digits_.empty() ||
+            std::memcmp(digits_.data(), rhs.digits_.data(), digits_.size() * sizeof(int)) == 0);
 }
 
 bool BigInt::operator!=(const BigInt& rhs) const {
-    return *this < rhs || rhs < *this;
+    return !(*this == rhs);
 }
 
 bool BigInt::operator<(int64_t rhs) const {
-    return *this < BigInt(rhs);
+    return compare(rhs) < 0;
 }
 
 bool operator<(int64_t lhs, const BigInt& rhs) {
-    return BigInt(lhs) < rhs;
+    return rhs.compare(lhs) > 0;
 }
 
 bool BigInt::operator>(int64_t rhs) const {
-    return *this > BigInt(rhs);
+    return compare(rhs) > 0;
 }
 
 bool operator>(int64_t lhs, const BigInt& rhs) {
-    return BigInt(lhs) > rhs;
+    return rhs.compare(lhs) < 0;
 }
 
 bool BigInt::operator<=(int64_t rhs) const {
-    return *this <= BigInt(rhs);
+    return compare(rhs) <= 0;
 }
 
 bool operator<=(int64_t lhs, const BigInt& rhs) {
-    return BigInt(lhs) <= rhs;
+    return rhs.compare(lhs) >= 0;
 }
 
 bool BigInt::operator>=(int64_t rhs) const {
-    return *this >= BigInt(rhs);
+    return compare(rhs) >= 0;
 }
 
 bool operator>=(int64_t lhs, const BigInt& rhs) {
-    return BigInt(lhs) >= rhs;
+    return rhs.compare(lhs) <= 0;
 }
 
 bool BigInt::operator==(int64_t rhs) const {
-    return *this == BigInt(rhs);
+    return compare(rhs) == 0;
 }
 
 bool operator==(int64_t lhs, const BigInt& rhs) {
-    return BigInt(lhs) == rhs;
+    return rhs.compare(lhs) == 0;
 }
 
 bool BigInt::operator!=(int64_t rhs) const {
-    return *this != BigInt(rhs);
+    return compare(rhs) != 0;
 }
 
 bool operator!=(int64_t lhs, const BigInt& rhs) {
-    return BigInt(lhs) != rhs;
+    return rhs.compare(lhs) != 0;
+}
+
+/*
+    Hashing; equal values have equal limbs, so the limbs and the sign are hashed directly.
+*/
+
+std::size_t std::hash<BigInt>::operator()(const BigInt& number) const noexcept {
+    uint64_t h = number.sign_ == -1 ? 0x9E3779B97F4A7C15ull : 0;
+    for (int digit : number.digits_) {
+        h = (h ^ static_cast<uint64_t>(digit)) * 0x100000001B3ull;
+        h ^= h >> 29;
+    }
+    return static_cast<std::size_t>(h ^ (h >> 32));
 }
 
 /*
@@ -618,6 +1172,25 @@ uint64_t BigInt::to_uint64_t(const BigInt& number) {
     return value;
 }
 
+std::string BigInt::serialize(const BigInt& number) {
+    std::string result(1, static_cast<char>(kSerializationVersion));
+    result.reserve(5 + number.digits_.size() * 4);
+    appendRecord(number, &result);
+    return result;
+}
+
+BigInt BigInt::deserialize(const std::string& data) {
+    if (data.empty() || data[0] != static_cast<char>(kSerializationVersion)) {
+        throw std::invalid_argument("Unsupported serialized BigInt version");
+    }
+    const unsigned char* record = reinterpret_cast<const unsigned char*>(data.data()) + 1;
+    if (data.size() < 5 ||
+        data.size() != 5 + static_cast<std::size_t>(loadLittleEndian32(record) & 0x7FFFFFFFu) * 4) {
+        throw std::invalid_argument("Malformed serialized BigInt");
+    }
+    return readRecord(record, data.size() - 1);
+}
+
 /*
     Increment and decrement operators
 */
@@ -1,7 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <iosfwd>
 #include <string>
 #include <vector>
 #include <utility>
 #include <type_traits>
+#include <functional>
+#include "shared_limbs.h"
+#if defined(__cpp_impl_three_way_comparison) && __cpp_impl_three_way_comparison >= 201907L
+#include <compare>
+#define BIG_INT_HAS_THREE_WAY_COMPARISON 1
+#endif
+
+template <std::size_t Bits, bool Signed>
+class WideInt;
+
+template <char... Chars>
+struct BigIntLiteral;
+
+class BigInt;
+
+namespace std {
+template <>
+struct hash<BigInt>;
+}  // namespace std
 
 class BigInt {
 public:
@@ -63,7 +87,31 @@ public:
     BigInt operator++(int);  // post-increment
     BigInt operator--(int);  // post-decrement
 
-    // Relational operators:
+    // Shift and bitwise operators with two's complement semantics: x >> k rounds towards minus
+    // infinity and ~x == -x - 1. The limbs are decimal, so shifts are not linear: up to 232
+    // bits they run in place, one linear pass per 29 bits, and longer ones cost a
+    // multiplication, x << k by 2^k and x >> k by 5^k before dropping k decimal digits.
+    // &, |, ^ and popcount work on binary limbs, and the conversions are quadratic in the
+    // length of the operands (0.65 s for two 200000-digit numbers).
+    BigInt& operator<<=(std::size_t);
+    BigInt& operator>>=(std::size_t);
+    BigInt& operator&=(const BigInt&);
+    BigInt& operator|=(const BigInt&);
+    BigInt& operator^=(const BigInt&);
+    BigInt operator<<(std::size_t) const;
+    BigInt operator>>(std::size_t) const;
+    BigInt operator&(const BigInt&) const;
+    BigInt operator|(const BigInt&) const;
+    BigInt operator^(const BigInt&) const;
+    BigInt operator~() const;
+
+    // Relational operators; compare() returns a negative, zero or positive value:
+    int compare(const BigInt&) const;
+    int compare(int64_t) const;
+#ifdef BIG_INT_HAS_THREE_WAY_COMPARISON
+    std::strong_ordering operator<=>(const BigInt&) const;
+    std::strong_ordering operator<=>(int64_t) const;
+#endif
     bool operator<(const BigInt&) const;
     bool operator>(const BigInt&) const;
     bool operator<=(const BigInt&) const;
@@ -92,25 +140,75 @@ public:
     BigInt abs() const;                                                     // NOLINT
     friend std::pair<BigInt, BigInt> divmod(const BigInt&, const BigInt&);  // NOLINT
 
+    // Fused multiply-accumulate: *acc += a * b, *acc -= a * b and the sum of a[i] * b[i]. The
+    // products are summed in a wide buffer and carries are propagated once per batch of rows.
+    friend void addmul(BigInt* acc, const BigInt& a, const BigInt& b);              // NOLINT
+    friend void submul(BigInt* acc, const BigInt& a, const BigInt& b);              // NOLINT
+    friend BigInt dot(const std::vector<BigInt>& a, const std::vector<BigInt>& b);  // NOLINT
+
+    // Bit queries; bit_length and popcount describe |x|, test_bit the two's complement of x.
+    // test_bit(k) and trailing_zeros() convert only the low decimal limbs that reach the bits
+    // asked for, so they are quadratic in k and in the answer, not in the length of x.
+    std::size_t bit_length() const;      // NOLINT
+    bool test_bit(std::size_t) const;    // NOLINT
+    std::size_t trailing_zeros() const;  // NOLINT; 0 for zero
+    std::size_t popcount() const;        // NOLINT
+
     // Conversion functions:
     static std::string to_string(const BigInt&);  // NOLINT
     static int to_int(const BigInt&);             // NOLINT
     static int64_t to_int64_t(const BigInt&);     // NOLINT
     static uint64_t to_uint64_t(const BigInt&);   // NOLINT
 
+    // Binary serialization: a format version byte followed by one record (see appendRecord).
+    static std::string serialize(const BigInt&);    // NOLINT
+    static BigInt deserialize(const std::string&);  // NOLINT
+
 private:
+    template <std::size_t, bool>
+    friend class WideInt;
+    template <char...>
+    friend struct BigIntLiteral;
+    friend class BigIntView;
+    friend class MappedBigIntArray;
+    friend class PreparedMultiplier;
+    friend struct std::hash<BigInt>;
+    friend struct BigIntAccess;
+
     static const int kBase = 1000000000;
     static const int kBaseDigits = 9;
+    static const int kSerializationVersion = 1;
+    static const int kShiftStep = 29;              // bits per in-place pass, 2^29 < kBase
+    static const int kInPlaceShiftLimit = 8 * 29;  // longer shifts multiply by a power
 
     int sign_;
-    std::vector<int> digits_;
+    SharedLimbs digits_;  // base-10^9 limbs, least significant first; shared between copies
 
     // Utility functions:
     void read(const std::string&);
     bool isValidNumber(const std::string&);
     void convert(const std::string&);
     void trim();
+    static void appendRecord(const BigInt&, std::string*);
+    static BigInt readRecord(const unsigned char*, std::size_t);
     static std::vector<int> convertBase(const std::vector<int>&, int, int);
+    static bool multipliesByNtt(std::size_t shorter, std::size_t longer);  // operand limbs
+    static BigInt accumulateProducts(const BigInt&, const BigInt*, const BigInt*, std::size_t,
+                                     int);
     static std::vector<int64_t> karatsubaMultiply(const std::vector<int64_t>&,
                                                   const std::vector<int64_t>&);
 };
+
+void addmul(BigInt* acc, const BigInt& a, const BigInt& b);              // NOLINT
+void submul(BigInt* acc, const BigInt& a, const BigInt& b);              // NOLINT
+BigInt dot(const std::vector<BigInt>& a, const std::vector<BigInt>& b);  // NOLINT
+
+// base^exponent by sliding-window exponentiation.
+BigInt pow(const BigInt& base, uint64_t exponent);  // NOLINT
+
+namespace std {
+template <>
+struct hash<BigInt> {
+    std::size_t operator()(const BigInt&) const noexcept;
+};
+}  // namespace std
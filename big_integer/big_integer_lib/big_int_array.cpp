@@ -0,0 +1,191 @@
+#include "big_int_array.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BIG_INT_HAS_MMAP 1
+#endif
+
+namespace {
+
+uint32_t loadLittleEndian32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t loadLittleEndian64(const unsigned char* p) {
+    return static_cast<uint64_t>(loadLittleEndian32(p)) |
+           (static_cast<uint64_t>(loadLittleEndian32(p + 4)) << 32);
+}
+
+void appendLittleEndian(std::string* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out->push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+const char kMagic[] = {'B', 'I', 'G', 'A'};
+
+}  // namespace
+
+/*
+    BigIntView
+*/
+
+BigIntView::BigIntView(const unsigned char* record) : record_(record) {
+}
+
+bool BigIntView::isNegative() const {
+    return (loadLittleEndian32(record_) >> 31) && size() > 0;
+}
+
+std::size_t BigIntView::size() const {
+    return loadLittleEndian32(record_) & 0x7FFFFFFFu;
+}
+
+uint32_t BigIntView::limb(std::size_t index) const {
+    return loadLittleEndian32(record_ + 4 * (index + 1));
+}
+
+BigInt BigIntView::toBigInt() const {
+    return BigInt::readRecord(record_, 4 * (size() + 1));
+}
+
+/*
+    MappedBigIntArray
+*/
+
+MappedBigIntArray::MappedBigIntArray(const std::string& path)
+    : data_(nullptr), length_(0), count_(0) {
+#ifdef BIG_INT_HAS_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open \'" + path + "\'");
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Cannot stat \'" + path + "\'");
+    }
+    length_ = static_cast<std::size_t>(info.st_size);
+    if (length_ > 0) {
+        void* mapping = mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Cannot map \'" + path + "\'");
+        }
+        data_ = static_cast<const unsigned char*>(mapping);
+    }
+    close(fd);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open \'" + path + "\'");
+    }
+    fallback_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    data_ = fallback_.data();
+    length_ = fallback_.size();
+#endif
+
+    if (length_ < kHeaderSize + 8 || std::memcmp(data_, kMagic, sizeof(kMagic)) != 0 ||
+        loadLittleEndian32(data_ + 4) != kVersion) {
+        release();
+        throw std::invalid_argument("\'" + path + "\' is not a BigInt array file");
+    }
+    const uint64_t count = loadLittleEndian64(data_ + 8);
+    if (count > (length_ - kHeaderSize) / 8 - 1) {
+        release();
+        throw std::invalid_argument("\'" + path + "\' is truncated");
+    }
+    count_ = static_cast<std::size_t>(count);
+}
+
+MappedBigIntArray::MappedBigIntArray(MappedBigIntArray&& other) noexcept
+    : data_(nullptr), length_(0), count_(0) {
+    *this = std::move(other);
+}
+
+MappedBigIntArray& MappedBigIntArray::operator=(MappedBigIntArray&& other) noexcept {
+    if (this != &other) {
+        release();
+        data_ = other.data_;
+        length_ = other.length_;
+        count_ = other.count_;
+        fallback_ = std::move(other.fallback_);
+        other.data_ = nullptr;
+        other.length_ = 0;
+        other.count_ = 0;
+    }
+    return *this;
+}
+
+MappedBigIntArray::~MappedBigIntArray() {
+    release();
+}
+
+void MappedBigIntArray::release() {
+#ifdef BIG_INT_HAS_MMAP
+    if (data_ != nullptr) {
+        munmap(const_cast<unsigned char*>(data_), length_);  // NOLINT
+    }
+#endif
+    data_ = nullptr;
+    length_ = 0;
+    count_ = 0;
+    fallback_.clear();
+}
+
+std::size_t MappedBigIntArray::size() const {
+    return count_;
+}
+
+uint64_t MappedBigIntArray::offset(std::size_t index) const {
+    return loadLittleEndian64(data_ + kHeaderSize + 8 * index);
+}
+
+BigIntView MappedBigIntArray::operator[](std::size_t index) const {
+    if (index >= count_) {
+        throw std::out_of_range("MappedBigIntArray index out of range");
+    }
+    const std::size_t data_start = kHeaderSize + 8 * (count_ + 1);
+    const uint64_t data_words = (length_ - data_start) / 4;
+    const uint64_t begin = offset(index);
+    const uint64_t end = offset(index + 1);
+    if (begin >= end || end > data_words) {
+        throw std::invalid_argument("Corrupted BigInt array record");
+    }
+    BigIntView view(data_ + data_start + 4 * begin);
+    if (view.size() != end - begin - 1) {
+        throw std::invalid_argument("Corrupted BigInt array record");
+    }
+    return view;
+}
+
+void MappedBigIntArray::write(const std::string& path, const std::vector<BigInt>& values) {
+    std::string header(kMagic, sizeof(kMagic));
+    appendLittleEndian(&header, kVersion, 4);
+    appendLittleEndian(&header, values.size(), 8);
+
+    std::string records;
+    uint64_t words = 0;
+    appendLittleEndian(&header, words, 8);
+    for (const BigInt& value : values) {
+        BigInt::appendRecord(value, &records);
+        words += 1 + value.digits_.size();
+        appendLittleEndian(&header, words, 8);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    out.write(records.data(), static_cast<std::streamsize>(records.size()));
+    if (!out) {
+        throw std::runtime_error("Cannot write \'" + path + "\'");
+    }
+}
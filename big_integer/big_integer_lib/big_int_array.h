@@ -0,0 +1,60 @@
+#pragma once
+
+#include "big_int.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+    Read-only view of one serialized BigInt record inside a MappedBigIntArray. The limbs are read
+    straight from the mapped file; toBigInt() is the only operation that copies them.
+*/
+class BigIntView {
+public:
+    explicit BigIntView(const unsigned char* record);
+
+    bool isNegative() const;
+    std::size_t size() const;           // number of base-10^9 limbs
+    uint32_t limb(std::size_t) const;   // least significant limb first
+    BigInt toBigInt() const;
+
+private:
+    const unsigned char* record_;
+};
+
+/*
+    Bulk container of BigInts stored in a single file. Opening maps the file into memory; values
+    are decoded lazily on access, so loading does not depend on the number of elements.
+
+    File layout (all integers little-endian):
+        "BIGA" magic, uint32 format version, uint64 element count,
+        uint64 offsets[count + 1] of the records in 32-bit words from the start of the data,
+        the records themselves (see BigInt::appendRecord).
+*/
+class MappedBigIntArray {
+public:
+    explicit MappedBigIntArray(const std::string& path);
+    MappedBigIntArray(MappedBigIntArray&&) noexcept;
+    MappedBigIntArray& operator=(MappedBigIntArray&&) noexcept;
+    MappedBigIntArray(const MappedBigIntArray&) = delete;
+    MappedBigIntArray& operator=(const MappedBigIntArray&) = delete;
+    ~MappedBigIntArray();
+
+    std::size_t size() const;
+    BigIntView operator[](std::size_t) const;  // throws std::out_of_range
+
+    static void write(const std::string& path, const std::vector<BigInt>&);
+
+private:
+    static const uint32_t kVersion = 1;
+    static const std::size_t kHeaderSize = 16;
+
+    const unsigned char* data_;
+    std::size_t length_;
+    std::size_t count_;
+    std::vector<unsigned char> fallback_;  // file contents when mmap is unavailable
+
+    void release();
+    uint64_t offset(std::size_t) const;
+};
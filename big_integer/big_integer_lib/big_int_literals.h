@@ -0,0 +1,192 @@
+#pragma once
+
+#include "big_int.h"
+#include "wide_int.h"
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+/*
+    Parsing of integer literal tokens at compile time. The characters are delivered by the
+    literal operator templates below, so prefixes (0x, 0b, leading 0 for octal) and digit
+    separators follow the usual C++ rules. The literal operators only accept integer tokens whose
+    digits are all below the radix: floating literals (1.5, 1e5, 0x1p3) and digits such as the 8
+    in 08 leave no viable operator, so they fail to compile.
+*/
+template <char... Chars>
+struct LiteralDigits {
+    static constexpr std::array<char, sizeof...(Chars)> kChars = {Chars...};
+
+    static constexpr int radix() {
+        if (kChars.size() > 2 && kChars[0] == '0' && (kChars[1] == 'x' || kChars[1] == 'X')) {
+            return 16;
+        }
+        if (kChars.size() > 2 && kChars[0] == '0' && (kChars[1] == 'b' || kChars[1] == 'B')) {
+            return 2;
+        }
+        if (kChars.size() > 1 && kChars[0] == '0') {
+            return 8;
+        }
+        return 10;
+    }
+
+    static constexpr std::size_t prefixLength() {
+        return radix() == 16 || radix() == 2 ? 2 : 0;
+    }
+
+    static constexpr int digitValue(char c) {
+        return c >= '0' && c <= '9'   ? c - '0'
+               : c >= 'a' && c <= 'f' ? c - 'a' + 10
+               : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                      : -1;
+    }
+
+    // Whether at least one digit follows the prefix and every one is below the radix.
+    static constexpr bool valid() {
+        std::size_t count = 0;
+        for (std::size_t i = prefixLength(); i < kChars.size(); ++i) {
+            if (kChars[i] == '\'') {
+                continue;
+            }
+            const int digit = digitValue(kChars[i]);
+            if (digit < 0 || digit >= radix()) {
+                return false;
+            }
+            ++count;
+        }
+        return count > 0;
+    }
+
+    static constexpr std::size_t digitCount() {
+        std::size_t count = 0;
+        for (std::size_t i = prefixLength(); i < kChars.size(); ++i) {
+            count += kChars[i] != '\'';
+        }
+        return count;
+    }
+
+    // Calls `consume(digit)` for every digit, most significant first.
+    template <typename Consumer>
+    static constexpr void forEachDigit(Consumer& consume) {
+        for (std::size_t i = prefixLength(); i < kChars.size(); ++i) {
+            if (kChars[i] != '\'') {
+                consume(digitValue(kChars[i]));
+            }
+        }
+    }
+};
+
+template <char... Chars>
+struct BigIntLiteral {
+    using Digits = LiteralDigits<Chars...>;
+    static_assert(Digits::valid(), "Not an integer literal in its radix");
+
+    // Upper bound on the number of base-10^9 limbs: every digit carries at most 4 bits and each
+    // limb holds more than 29 bits.
+    static constexpr std::size_t kCapacity = Digits::digitCount() * 4 / 29 + 1;
+
+    struct Limbs {
+        std::array<int, kCapacity> digits{};
+        std::size_t size = 0;
+
+        constexpr void operator()(int digit) {
+            int64_t carry = digit;
+            for (std::size_t i = 0; i < size; ++i) {
+                carry += static_cast<int64_t>(digits[i]) * Digits::radix();
+                digits[i] = static_cast<int>(carry % BigInt::kBase);
+                carry /= BigInt::kBase;
+            }
+            if (carry) {
+                digits[size++] = static_cast<int>(carry);
+            }
+        }
+    };
+
+    static constexpr Limbs parse() {
+        Limbs limbs;
+        Digits::forEachDigit(limbs);
+        return limbs;
+    }
+
+    static constexpr Limbs kLimbs = parse();
+
+    static BigInt value() {
+        BigInt result;
+        result.digits_.assign(kLimbs.digits.begin(), kLimbs.digits.begin() + kLimbs.size);
+        return result;
+    }
+};
+
+template <typename Wide, char... Chars>
+constexpr Wide parseWideLiteral() {
+    using Digits = LiteralDigits<Chars...>;
+    static_assert(Digits::valid(), "Not an integer literal in its radix");
+    // One spare limb catches the overflow of a single multiply-add step.
+    struct Accumulator {
+        WideUInt<Wide::kLimbs * 32 + 32> value;
+
+        constexpr void operator()(int digit) {
+            value = value * Digits::radix() + digit;
+            if (value.limbs()[Wide::kLimbs]) {
+                throw std::out_of_range("Integer literal does not fit into WideInt");
+            }
+        }
+    };
+    Accumulator accumulator{};
+    Digits::forEachDigit(accumulator);
+    Wide result(accumulator.value);
+    if (result < 0) {
+        throw std::out_of_range("Integer literal does not fit into WideInt");
+    }
+    return result;
+}
+
+namespace big_int_literals {
+
+// 123456789101112131415_big: the limbs are computed by the compiler and stored statically, so
+// building the value only copies them.
+template <char... Chars>
+typename std::enable_if<LiteralDigits<Chars...>::valid(), BigInt>::type operator""_big() {
+    return BigIntLiteral<Chars...>::value();
+}
+
+// Fixed-width literals, usable in constant expressions: constexpr auto kP = 0xFFFF..._u256;
+template <char... Chars>
+constexpr typename std::enable_if<LiteralDigits<Chars...>::valid(), Int128>::type
+operator""_i128() {
+    return parseWideLiteral<Int128, Chars...>();
+}
+
+template <char... Chars>
+constexpr typename std::enable_if<LiteralDigits<Chars...>::valid(), UInt128>::type
+operator""_u128() {
+    return parseWideLiteral<UInt128, Chars...>();
+}
+
+template <char... Chars>
+constexpr typename std::enable_if<LiteralDigits<Chars...>::valid(), Int256>::type
+operator""_i256() {
+    return parseWideLiteral<Int256, Chars...>();
+}
+
+template <char... Chars>
+constexpr typename std::enable_if<LiteralDigits<Chars...>::valid(), UInt256>::type
+operator""_u256() {
+    return parseWideLiteral<UInt256, Chars...>();
+}
+
+template <char... Chars>
+constexpr typename std::enable_if<LiteralDigits<Chars...>::valid(), Int512>::type
+operator""_i512() {
+    return parseWideLiteral<Int512, Chars...>();
+}
+
+template <char... Chars>
+constexpr typename std::enable_if<LiteralDigits<Chars...>::valid(), UInt512>::type
+operator""_u512() {
+    return parseWideLiteral<UInt512, Chars...>();
+}
+
+}  // namespace big_int_literals
@@ -0,0 +1,96 @@
+#include "budget.h"
+
+namespace {
+
+thread_local const BudgetScope* current_scope = nullptr;
+
+}  // namespace
+
+/*
+    CancellationToken
+*/
+
+void CancellationToken::cancel() {
+    cancelled_.store(true, std::memory_order_relaxed);
+}
+
+void CancellationToken::reset() {
+    cancelled_.store(false, std::memory_order_relaxed);
+}
+
+bool CancellationToken::cancelled() const {
+    return cancelled_.load(std::memory_order_relaxed);
+}
+
+EvaluationAborted::EvaluationAborted(const std::string& message) : std::runtime_error(message) {
+}
+
+/*
+    BudgetScope
+*/
+
+BudgetScope::BudgetScope(const EvaluationBudget& budget)
+    : budget_(budget), has_deadline_(false), previous_(current_scope) {
+    if (budget_.time_limit.count() > 0) {
+        // A limit beyond the clock's range saturates instead of overflowing it.
+        const auto now = std::chrono::steady_clock::now();
+        const auto room = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::time_point::max() - now);
+        deadline_ = budget_.time_limit >= room ? std::chrono::steady_clock::time_point::max()
+                                               : now + budget_.time_limit;
+        has_deadline_ = true;
+    }
+    if (previous_ != nullptr && previous_->has_deadline_ &&
+        (!has_deadline_ || previous_->deadline_ < deadline_)) {
+        deadline_ = previous_->deadline_;
+        has_deadline_ = true;
+    }
+    if (previous_ != nullptr) {
+        // Limits of enclosing scopes stay in force.
+        const EvaluationBudget& outer = previous_->budget_;
+        auto tighter = [](std::size_t a, std::size_t b) { return a && (!b || a < b) ? a : b; };
+        budget_.max_operand_digits = tighter(outer.max_operand_digits, budget_.max_operand_digits);
+        budget_.max_result_digits = tighter(outer.max_result_digits, budget_.max_result_digits);
+        if (budget_.cancellation == nullptr) {
+            budget_.cancellation = outer.cancellation;
+        }
+    }
+    current_scope = this;
+}
+
+BudgetScope::~BudgetScope() {
+    current_scope = previous_;
+}
+
+const EvaluationBudget* BudgetScope::current() {
+    return current_scope == nullptr ? nullptr : &current_scope->budget_;
+}
+
+void BudgetScope::checkpoint() {
+    const BudgetScope* scope = current_scope;
+    if (scope == nullptr) {
+        return;
+    }
+    if (scope->budget_.cancellation != nullptr && scope->budget_.cancellation->cancelled()) {
+        throw EvaluationAborted("Evaluation cancelled");
+    }
+    if (scope->has_deadline_ && std::chrono::steady_clock::now() > scope->deadline_) {
+        throw EvaluationAborted("Evaluation timed out");
+    }
+}
+
+void BudgetScope::checkOperand(std::size_t digits) {
+    const EvaluationBudget* budget = current();
+    if (budget != nullptr && budget->max_operand_digits && digits > budget->max_operand_digits) {
+        throw EvaluationAborted("Operand exceeds " + std::to_string(budget->max_operand_digits) +
+                                " digits");
+    }
+}
+
+void BudgetScope::checkResult(std::size_t digits) {
+    const EvaluationBudget* budget = current();
+    if (budget != nullptr && budget->max_result_digits && digits > budget->max_result_digits) {
+        throw EvaluationAborted("Result would exceed " +
+                                std::to_string(budget->max_result_digits) + " digits");
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+/*
+    Evaluation budgets. A BudgetScope installs limits for the current thread; the long-running
+    loops of the library (Karatsuba recursion, long division, the binary schoolbook kernels)
+    call checkpoint() every few thousand limb operations, which throws EvaluationAborted once
+    the deadline has passed or the cancellation token fired. Size limits are checked by the
+    evaluator before an operation starts, from estimates of the result size.
+
+    Work handed to other threads (the product trees in combinatorics) does not inherit the
+    budget of the calling thread.
+*/
+
+// Set from any thread (or a signal handler) to stop the evaluations that watch it.
+class CancellationToken {
+public:
+    void cancel();
+    void reset();
+    bool cancelled() const;
+
+private:
+    std::atomic<bool> cancelled_{false};
+};
+
+// Limits of one evaluation; zero means unlimited.
+struct EvaluationBudget {
+    std::size_t max_operand_digits = 0;
+    std::size_t max_result_digits = 0;
+    std::chrono::milliseconds time_limit{0};
+    const CancellationToken* cancellation = nullptr;
+};
+
+class EvaluationAborted : public std::runtime_error {
+public:
+    explicit EvaluationAborted(const std::string& message);
+};
+
+class BudgetScope {
+public:
+    // The deadline is time_limit from now, or that of an enclosing scope if it is earlier.
+    explicit BudgetScope(const EvaluationBudget& budget);
+    ~BudgetScope();
+    BudgetScope(const BudgetScope&) = delete;
+    BudgetScope& operator=(const BudgetScope&) = delete;
+
+    // The innermost budget of this thread, or nullptr.
+    static const EvaluationBudget* current();
+
+    // Throws EvaluationAborted if the current budget is cancelled or out of time.
+    static void checkpoint();
+
+    // Throws EvaluationAborted if a value of about `digits` decimal digits exceeds a limit.
+    static void checkOperand(std::size_t digits);
+    static void checkResult(std::size_t digits);
+
+private:
+    EvaluationBudget budget_;
+    std::chrono::steady_clock::time_point deadline_;
+    bool has_deadline_;
+    const BudgetScope* previous_;
+};
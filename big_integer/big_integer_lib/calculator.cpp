@@ -0,0 +1,425 @@
+#include "calculator.h"
+#include <algorithm>
+#include <cctype>
+#include <stack>
+#include <list>
+#include <stdexcept>
+#include <utility>
+
+/*
+    Parsing
+*/
+
+namespace {
+
+const int kLeftAssoc = 0;
+const int kRightAssoc = 1;
+
+// Map the different operators: +, -, *, / etc
+typedef std::map<std::string, std::pair<int, int>> OpMap;
+
+const OpMap::value_type kAssocs[] = {
+    OpMap::value_type("+", {0, kLeftAssoc}), OpMap::value_type("-", {0, kLeftAssoc}),
+    OpMap::value_type("*", {5, kLeftAssoc}), OpMap::value_type("/", {5, kLeftAssoc}),
+    OpMap::value_type("%", {5, kLeftAssoc})};
+
+const OpMap kOpmap(kAssocs, kAssocs + sizeof(kAssocs) / sizeof(kAssocs[0]));
+
+bool isAssociative(const std::string& token, int type) {
+    const std::pair<int, int> p = kOpmap.find(token)->second;
+    return p.second == type;
+}
+
+int cmpPrecedence(const std::string& token1, const std::string& token2) {
+    const std::pair<int, int> p1 = kOpmap.find(token1)->second;
+    const std::pair<int, int> p2 = kOpmap.find(token2)->second;
+
+    return p1.first - p2.first;
+}
+
+// Decimal digits of |x|, from its bit length; at most one too many.
+std::size_t digitEstimate(const BigInt& x) {
+    return static_cast<std::size_t>(static_cast<double>(x.bit_length()) * 0.30103) + 1;
+}
+
+// Upper bound on the digits of d1 `operation` d2 for operands of d1 and d2 digits.
+std::size_t resultEstimate(const std::string& operation, std::size_t d1, std::size_t d2) {
+    if (operation == "*") {
+        return d1 + d2;
+    }
+    if (operation == "/") {
+        return d1 >= d2 ? d1 - d2 + 1 : 1;
+    }
+    if (operation == "%") {
+        return std::min(d1, d2);
+    }
+    return std::max(d1, d2) + 1;
+}
+
+}  // namespace
+
+bool isParenthesis(const std::string& token) {
+    return token == "(" || token == ")";
+}
+
+bool isOperator(const std::string& token) {
+    return token == "+" || token == "-" || token == "*" || token == "/" || token == "%";
+}
+
+bool isIdentifier(const std::string& token) {
+    if (token.empty() || !(std::isalpha(static_cast<unsigned char>(token[0])) || token[0] == '_')) {
+        return false;
+    }
+    for (char c : token) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool infixToRPN(std::queue<std::string>* input_tokens, int size,
+                std::vector<std::string>* str_array) {
+    bool success = true;
+
+    std::list<std::string> out;
+    std::stack<std::string> stack;
+
+    for (int i = 0; i < size; ++i) {
+        const std::string token = input_tokens->front();
+        input_tokens->pop();
+
+        if (isOperator(token)) {
+            const std::string o1 = token;
+
+            if (!stack.empty()) {
+                std::string o2 = stack.top();
+
+                while (isOperator(o2) &&
+                       ((isAssociative(o1, kLeftAssoc) && cmpPrecedence(o1, o2) == 0) ||
+                        cmpPrecedence(o1, o2) < 0)) {
+                    stack.pop();
+                    out.push_back(o2);
+
+                    if (!stack.empty()) {
+                        o2 = stack.top();
+                    } else {
+                        break;
+                    }
+                }
+            }
+
+            stack.push(o1);
+        } else if (token == "(") {
+            stack.push(token);
+        } else if (token == ")") {
+            if (stack.empty()) {
+                return false;
+            }
+            std::string top_token = stack.top();
+
+            while (top_token != "(") {
+                out.push_back(top_token);
+                stack.pop();
+                if (stack.empty()) {
+                    break;
+                }
+                top_token = stack.top();
+            }
+
+            if (!stack.empty()) {
+                stack.pop();
+            }
+
+            if (top_token != "(") {
+                return false;
+            }
+        } else {
+            out.push_back(token);
+        }
+    }
+
+    while (!stack.empty()) {
+        const std::string stack_token = stack.top();
+
+        if (isParenthesis(stack_token)) {
+            return false;
+        }
+        out.push_back(stack_token);
+        stack.pop();
+    }
+
+    str_array->assign(out.begin(), out.end());
+    return success;
+}
+
+std::queue<std::string> getExpressionTokens(const std::string& expression) {
+    std::queue<std::string> tokens;
+    std::string str;
+    for (char expression_char : expression) {
+        const std::string token(1, expression_char);
+
+        if (isOperator(token) || isParenthesis(token)) {
+            if (!str.empty()) {
+                tokens.push(str);
+            }
+            str.clear();
+            tokens.push(token);
+        } else {
+            if (!token.empty() && token != " " && token != "\t") {
+                str.append(token);
+            } else {
+                if (!str.empty()) {
+                    tokens.push(str);
+                    str.clear();
+                }
+            }
+        }
+    }
+    if (!str.empty()) {
+        tokens.push(str);
+    }
+    return tokens;
+}
+
+/*
+    Evaluation
+*/
+
+BigInt evaluateRPN(const std::vector<std::string>& tokens,
+                   const std::function<BigInt(const std::string&)>& lookup,
+                   const EvaluationBudget& budget) {
+    const BudgetScope scope(budget);
+    std::stack<BigInt> st;
+
+    for (const std::string& token : tokens) {
+        BudgetScope::checkpoint();
+        if (!isOperator(token)) {
+            if (isIdentifier(token)) {
+                st.push(lookup(token));
+                BudgetScope::checkOperand(digitEstimate(st.top()));
+            } else {
+                BudgetScope::checkOperand(token.size());
+                st.push(BigInt(token));
+            }
+            continue;
+        }
+        if (st.empty()) {
+            throw std::invalid_argument("Missing operand of '" + token + "'");
+        }
+        const BigInt d2 = st.top();
+        st.pop();
+
+        if (st.empty()) {
+            st.push(token == "-" ? -d2 : d2);
+            continue;
+        }
+        const BigInt d1 = st.top();
+        st.pop();
+        if ((token == "/" || token == "%") && d2 == 0) {
+            throw std::domain_error("Division by zero");
+        }
+        const std::size_t digits1 = digitEstimate(d1);
+        const std::size_t digits2 = digitEstimate(d2);
+        BudgetScope::checkOperand(std::max(digits1, digits2));
+        BudgetScope::checkResult(resultEstimate(token, digits1, digits2));
+        st.push(token == "+"   ? d1 + d2
+                : token == "-" ? d1 - d2
+                : token == "*" ? d1 * d2
+                : token == "/" ? d1 / d2
+                               : d1 % d2);
+    }
+
+    if (st.size() != 1) {
+        throw std::invalid_argument("Malformed expression");
+    }
+    return st.top();
+}
+
+BigInt rpNtoBigInt(const std::vector<std::string>& tokens) {
+    return evaluateRPN(tokens, [](const std::string& name) -> BigInt {
+        throw std::out_of_range("Undefined variable '" + name + "'");
+    });
+}
+
+/*
+    FormulaEngine
+*/
+
+bool FormulaEngine::parseAssignment(const std::string& line, std::string* name,
+                                    std::string* expression) {
+    const std::size_t equals = line.find('=');
+    if (equals == std::string::npos) {
+        return false;
+    }
+    const std::size_t first = line.find_first_not_of(" \t");
+    const std::size_t last = line.find_last_not_of(" \t", equals - 1);
+    *name = first < equals ? line.substr(first, last - first + 1) : "";
+    *expression = line.substr(equals + 1);
+    return true;
+}
+
+std::vector<std::string> FormulaEngine::compile(const std::string& expression) {
+    std::queue<std::string> tokens = getExpressionTokens(expression);
+    if (tokens.empty()) {
+        throw std::invalid_argument("Empty expression");
+    }
+    std::vector<std::string> rpn;
+    if (!infixToRPN(&tokens, tokens.size(), &rpn)) {
+        throw std::invalid_argument("Mis-match in parentheses");
+    }
+    for (const std::string& token : rpn) {
+        if (!isOperator(token) && !isIdentifier(token)) {
+            BigInt literal(token);  // throws std::invalid_argument for anything else
+        }
+    }
+    return rpn;
+}
+
+bool FormulaEngine::reaches(const std::string& from, const std::string& target) const {
+    std::vector<std::string> pending = {from};
+    std::set<std::string> visited = {from};
+    while (!pending.empty()) {
+        const std::string name = pending.back();
+        pending.pop_back();
+        if (name == target) {
+            return true;
+        }
+        const auto it = formulas_.find(name);
+        if (it == formulas_.end()) {
+            continue;
+        }
+        for (const std::string& dependency : it->second.dependencies) {
+            if (visited.insert(dependency).second) {
+                pending.push_back(dependency);
+            }
+        }
+    }
+    return false;
+}
+
+// A stale formula has only stale dependents, so propagation stops at the first stale one.
+void FormulaEngine::markStale(const std::string& name) {
+    std::vector<std::string> pending(formulas_[name].dependents.begin(),
+                                     formulas_[name].dependents.end());
+    formulas_[name].stale = true;
+    while (!pending.empty()) {
+        Formula& formula = formulas_[pending.back()];
+        pending.pop_back();
+        if (!formula.stale) {
+            formula.stale = true;
+            pending.insert(pending.end(), formula.dependents.begin(), formula.dependents.end());
+        }
+    }
+}
+
+void FormulaEngine::assign(const std::string& name, const std::string& expression) {
+    if (!isIdentifier(name)) {
+        throw std::invalid_argument("Invalid variable name '" + name + "'");
+    }
+    std::vector<std::string> rpn = compile(expression);
+    std::set<std::string> dependencies;
+    for (const std::string& token : rpn) {
+        if (isIdentifier(token)) {
+            dependencies.insert(token);
+        }
+    }
+    for (const std::string& dependency : dependencies) {
+        if (reaches(dependency, name)) {
+            throw std::invalid_argument("Circular reference: '" + name + "' depends on itself");
+        }
+    }
+
+    Formula& formula = formulas_[name];
+    for (const std::string& dependency : formula.dependencies) {
+        formulas_[dependency].dependents.erase(name);
+    }
+    for (const std::string& dependency : dependencies) {
+        formulas_[dependency].dependents.insert(name);
+    }
+    formula.rpn = std::move(rpn);
+    formula.dependencies = std::move(dependencies);
+    formula.defined = true;
+    formula.edited = true;
+    markStale(name);
+}
+
+const BigInt& FormulaEngine::refresh(const std::string& name) {
+    const auto it = formulas_.find(name);
+    if (it == formulas_.end() || !it->second.defined) {
+        throw std::out_of_range("Undefined variable '" + name + "'");
+    }
+    Formula& formula = it->second;
+    if (!formula.stale) {
+        return formula.value;
+    }
+
+    bool inputs_changed = formula.edited;
+    for (const std::string& dependency : formula.dependencies) {
+        refresh(dependency);
+        inputs_changed |= formulas_.find(dependency)->second.changed > formula.evaluated;
+    }
+    if (inputs_changed) {
+        BigInt value = evaluateRPN(
+            formula.rpn,
+            [this](const std::string& dependency) {
+                return formulas_.find(dependency)->second.value;
+            },
+            budget_);
+        ++evaluations_;
+        if (formula.evaluated == 0 || value != formula.value) {
+            formula.value = value;
+            formula.changed = ++revision_;
+        }
+    }
+    formula.evaluated = ++revision_;
+    formula.edited = false;
+    formula.stale = false;
+    return formula.value;
+}
+
+const BigInt& FormulaEngine::value(const std::string& name) {
+    const BudgetScope scope(budget_);
+    return refresh(name);
+}
+
+BigInt FormulaEngine::evaluate(const std::string& expression) {
+    const BudgetScope scope(budget_);
+    return evaluateRPN(
+        compile(expression), [this](const std::string& name) { return refresh(name); }, budget_);
+}
+
+void FormulaEngine::setBudget(const EvaluationBudget& budget) {
+    budget_ = budget;
+}
+
+bool FormulaEngine::isDefined(const std::string& name) const {
+    const auto it = formulas_.find(name);
+    return it != formulas_.end() && it->second.defined;
+}
+
+bool FormulaEngine::isStale(const std::string& name) const {
+    const auto it = formulas_.find(name);
+    return it == formulas_.end() || it->second.stale;
+}
+
+std::vector<std::string> FormulaEngine::dependencies(const std::string& name) const {
+    const auto it = formulas_.find(name);
+    if (it == formulas_.end()) {
+        return {};
+    }
+    return std::vector<std::string>(it->second.dependencies.begin(),
+                                    it->second.dependencies.end());
+}
+
+std::vector<std::string> FormulaEngine::dependents(const std::string& name) const {
+    const auto it = formulas_.find(name);
+    if (it == formulas_.end()) {
+        return {};
+    }
+    return std::vector<std::string>(it->second.dependents.begin(), it->second.dependents.end());
+}
+
+std::size_t FormulaEngine::evaluations() const {
+    return evaluations_;
+}
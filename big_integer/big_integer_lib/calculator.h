@@ -0,0 +1,95 @@
+#pragma once
+
+#include "big_int.h"
+#include "budget.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+    Expression handling of the calculator: tokens are split off the input line, converted to
+    reverse Polish notation by the shunting-yard algorithm and evaluated on a stack of BigInts.
+*/
+
+bool isParenthesis(const std::string& token);
+bool isOperator(const std::string& token);
+bool isIdentifier(const std::string& token);  // a letter or '_' followed by letters, digits, '_'
+
+std::queue<std::string> getExpressionTokens(const std::string& expression);
+bool infixToRPN(std::queue<std::string>* input_tokens, int size,
+                std::vector<std::string>* str_array);
+
+// Evaluates RPN tokens whose operands are integer literals or names resolved by `lookup`. A
+// binary operator applied to a single operand is unary. Throws std::invalid_argument for
+// malformed input and std::domain_error on division by zero. Every operation runs under
+// `budget`: operand sizes and the estimated result size are checked before it starts, and
+// EvaluationAborted is thrown as soon as a limit is hit.
+BigInt evaluateRPN(const std::vector<std::string>& tokens,
+                   const std::function<BigInt(const std::string&)>& lookup,
+                   const EvaluationBudget& budget = EvaluationBudget());
+BigInt rpNtoBigInt(const std::vector<std::string>& tokens);
+
+/*
+    Named formulas that depend on each other, spreadsheet style. Assigning a formula records its
+    dependencies and marks it and everything downstream stale; nothing is evaluated until a
+    value is requested. A request brings the stale dependencies up to date first, and a formula
+    is re-evaluated only if one of its inputs actually changed value since it was last computed,
+    so an edit that does not change a value stops propagating there.
+*/
+class FormulaEngine {
+public:
+    // Splits "name = expression"; false if the line is not an assignment.
+    static bool parseAssignment(const std::string& line, std::string* name,
+                                std::string* expression);
+
+    // Defines or redefines a variable. Throws std::invalid_argument for a bad name or
+    // expression, or if the formula would depend on itself.
+    void assign(const std::string& name, const std::string& expression);
+
+    // The current value of a variable; throws std::out_of_range if it or one of its inputs is
+    // undefined.
+    const BigInt& value(const std::string& name);
+
+    // Evaluates an expression over the current variables without storing it.
+    BigInt evaluate(const std::string& expression);
+
+    // Limits applied to each value() or evaluate() call as a whole, including the stale inputs
+    // it recomputes. An aborted formula stays stale.
+    void setBudget(const EvaluationBudget& budget);
+
+    bool isDefined(const std::string& name) const;
+    bool isStale(const std::string& name) const;
+    std::vector<std::string> dependencies(const std::string& name) const;
+    std::vector<std::string> dependents(const std::string& name) const;
+
+    // Number of formula evaluations so far.
+    std::size_t evaluations() const;
+
+private:
+    struct Formula {
+        std::vector<std::string> rpn;
+        std::set<std::string> dependencies;
+        std::set<std::string> dependents;  // kept for undefined names too
+        BigInt value;
+        bool defined = false;
+        bool stale = true;
+        bool edited = true;      // formula replaced since the last evaluation
+        uint64_t changed = 0;    // revision at which the value last changed
+        uint64_t evaluated = 0;  // revision at which the value was last computed
+    };
+
+    std::map<std::string, Formula> formulas_;
+    uint64_t revision_ = 0;
+    std::size_t evaluations_ = 0;
+    EvaluationBudget budget_;
+
+    static std::vector<std::string> compile(const std::string& expression);
+    bool reaches(const std::string& from, const std::string& target) const;
+    void markStale(const std::string& name);
+    const BigInt& refresh(const std::string& name);
+};
@@ -0,0 +1,145 @@
+#include "combinatorics.h"
+#include <algorithm>
+#include <future>
+#include <thread>
+
+namespace {
+
+// Below this many operands a subtree is not worth a thread of its own.
+const std::size_t kParallelGrain = 64;
+
+int parallelDepth() {
+    int depth = 0;
+    for (unsigned int threads = std::thread::hardware_concurrency(); threads > 1; threads >>= 1) {
+        ++depth;
+    }
+    return depth;
+}
+
+template <typename Combine>
+BigInt reduceTree(const BigInt* values, std::size_t count, int depth, const Combine& combine) {
+    if (count == 1) {
+        return values[0];
+    }
+    if (count == 2) {
+        return combine(values[0], values[1]);
+    }
+    const std::size_t half = count / 2;
+    if (depth > 0 && count >= kParallelGrain) {
+        std::future<BigInt> left =
+            std::async(std::launch::async, [values, half, depth, &combine]() {
+                return reduceTree(values, half, depth - 1, combine);
+            });
+        BigInt right = reduceTree(values + half, count - half, depth - 1, combine);
+        return combine(left.get(), right);
+    }
+    return combine(reduceTree(values, half, 0, combine),
+                   reduceTree(values + half, count - half, 0, combine));
+}
+
+std::vector<uint32_t> primesUpTo(uint32_t n) {
+    std::vector<uint32_t> primes;
+    std::vector<bool> composite(static_cast<std::size_t>(n) + 1);
+    for (uint64_t i = 2; i <= n; ++i) {
+        if (!composite[i]) {
+            primes.push_back(static_cast<uint32_t>(i));
+            for (uint64_t j = i * i; j <= n; j += i) {
+                composite[j] = true;
+            }
+        }
+    }
+    return primes;
+}
+
+// Collects the prime powers of a factorisation into BigInt factors of up to 60 bits each, so the
+// product tree starts from a few large leaves instead of many tiny ones.
+class FactorCollector {
+public:
+    void add(uint32_t prime, uint64_t exponent) {
+        for (; exponent > 0; --exponent) {
+            if (word_ > (uint64_t(1) << 60) / prime) {
+                factors_.emplace_back(word_);
+                word_ = 1;
+            }
+            word_ *= prime;
+        }
+    }
+
+    BigInt product() {
+        if (word_ > 1) {
+            factors_.emplace_back(word_);
+            word_ = 1;
+        }
+        return factors_.empty() ? BigInt(1) : ::product(factors_);
+    }
+
+private:
+    std::vector<BigInt> factors_;
+    uint64_t word_ = 1;
+};
+
+// swing(n) = n! / ((n / 2)!)^2; the exponent of p is the number of odd floor(n / p^i).
+BigInt swing(uint32_t n, const std::vector<uint32_t>& primes) {
+    FactorCollector collector;
+    for (uint32_t prime : primes) {
+        if (prime > n) {
+            break;
+        }
+        uint64_t exponent = 0;
+        for (uint64_t q = n / prime; q > 0; q /= prime) {
+            exponent += q & 1;
+        }
+        collector.add(prime, exponent);
+    }
+    return collector.product();
+}
+
+BigInt factorialRecursive(uint32_t n, const std::vector<uint32_t>& primes) {
+    if (n < 20) {
+        uint64_t value = 1;
+        for (uint32_t i = 2; i <= n; ++i) {
+            value *= i;
+        }
+        return BigInt(value);
+    }
+    const BigInt half = factorialRecursive(n / 2, primes);
+    return half * half * swing(n, primes);
+}
+
+}  // namespace
+
+BigInt product(const std::vector<BigInt>& values) {
+    if (values.empty()) {
+        return 1;
+    }
+    return reduceTree(values.data(), values.size(), parallelDepth(),
+                      [](const BigInt& a, const BigInt& b) { return a * b; });
+}
+
+BigInt sum(const std::vector<BigInt>& values) {
+    if (values.empty()) {
+        return 0;
+    }
+    return reduceTree(values.data(), values.size(), parallelDepth(),
+                      [](const BigInt& a, const BigInt& b) { return a + b; });
+}
+
+BigInt factorial(uint32_t n) {
+    return factorialRecursive(n, primesUpTo(n));
+}
+
+BigInt binomial(uint32_t n, uint32_t k) {
+    if (k > n) {
+        return 0;
+    }
+    k = std::min(k, n - k);
+    FactorCollector collector;
+    for (uint32_t prime : primesUpTo(n)) {
+        uint64_t exponent = 0;
+        for (uint64_t power = prime; power <= n; power *= prime) {
+            exponent += n / power - k / power - (n - k) / power;
+        }
+        collector.add(prime, exponent);
+    }
+    return collector.product();
+}
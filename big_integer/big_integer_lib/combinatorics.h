@@ -0,0 +1,20 @@
+#pragma once
+
+#include "big_int.h"
+#include <cstdint>
+#include <vector>
+
+/*
+    Batch reductions over many BigInts. Both use balanced trees so that operands of similar size
+    meet at every level, and the upper levels of the tree are evaluated on separate threads.
+*/
+BigInt product(const std::vector<BigInt>& values);  // NOLINT
+BigInt sum(const std::vector<BigInt>& values);      // NOLINT
+
+// n! via the prime swing algorithm (P. Luschny): n! = ((n / 2)!)^2 * swing(n). The top levels
+// are products of millions of digits, which operator* hands to number-theoretic transforms;
+// 1000000! takes about 3 s on one core.
+BigInt factorial(uint32_t n);  // NOLINT
+
+// Binomial coefficient C(n, k) from its prime factorisation (Legendre / Kummer).
+BigInt binomial(uint32_t n, uint32_t k);  // NOLINT
@@ -0,0 +1,117 @@
+#include "divisor.h"
+#include "natural.h"
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+const uint64_t kDecimalBase = 1000000000;
+
+// Full 64 x 64 -> 128-bit product.
+void multiply(uint64_t a, uint64_t b, uint64_t* high, uint64_t* low) {
+#ifdef __SIZEOF_INT128__
+    const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    *high = static_cast<uint64_t>(product >> 64);
+    *low = static_cast<uint64_t>(product);
+#else
+    const uint64_t a0 = a & 0xFFFFFFFFu, a1 = a >> 32;
+    const uint64_t b0 = b & 0xFFFFFFFFu, b1 = b >> 32;
+    const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    const uint64_t middle = (p00 >> 32) + (p01 & 0xFFFFFFFFu) + (p10 & 0xFFFFFFFFu);
+    *low = (middle << 32) | (p00 & 0xFFFFFFFFu);
+    *high = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+#endif
+}
+
+}  // namespace
+
+Divisor::Divisor(int64_t divisor) : value_(divisor), shift_(0) {
+    if (divisor == 0) {
+        throw std::domain_error("Division by zero");
+    }
+    normalized_ = divisor < 0 ? ~static_cast<uint64_t>(divisor) + 1 : divisor;
+    while (!(normalized_ >> 63)) {
+        normalized_ <<= 1;
+        ++shift_;
+    }
+    // reciprocal = floor((2^128 - 1) / d) - 2^64 = floor((~d * 2^64 + 2^64 - 1) / d), computed by
+    // restoring division once per divisor.
+    uint64_t remainder = ~normalized_;
+    uint64_t quotient = 0;
+    for (int i = 63; i >= 0; --i) {
+        const bool overflow = remainder >> 63;
+        remainder = (remainder << 1) | 1;
+        quotient <<= 1;
+        if (overflow || remainder >= normalized_) {
+            remainder -= normalized_;
+            quotient |= 1;
+        }
+    }
+    reciprocal_ = quotient;
+}
+
+int64_t Divisor::value() const {
+    return value_;
+}
+
+uint64_t Divisor::step(uint64_t* r, uint32_t limb) const {
+    // (u1, u0) = (r * 10^9 + limb) << shift
+    uint64_t u1 = 0;
+    uint64_t u0 = 0;
+    multiply(*r, kDecimalBase, &u1, &u0);
+    u0 += limb;
+    u1 += u0 < limb;
+    if (shift_) {
+        u1 = (u1 << shift_) | (u0 >> (64 - shift_));
+        u0 <<= shift_;
+    }
+
+    uint64_t q1 = 0;
+    uint64_t q0 = 0;
+    multiply(reciprocal_, u1, &q1, &q0);
+    q0 += u0;
+    q1 += u1 + 1 + (q0 < u0);
+    uint64_t rem = u0 - q1 * normalized_;
+    if (rem > q0) {
+        --q1;
+        rem += normalized_;
+    }
+    if (rem >= normalized_) {
+        ++q1;
+        rem -= normalized_;
+    }
+    *r = rem >> shift_;
+    return q1;
+}
+
+int64_t Divisor::remainder(const BigInt& number) const {
+    const std::vector<int>& digits = BigIntAccess::digits(number);
+    uint64_t r = 0;
+    for (std::size_t i = digits.size(); i-- > 0;) {
+        step(&r, static_cast<uint32_t>(digits[i]));
+    }
+    return number < 0 ? -static_cast<int64_t>(r) : static_cast<int64_t>(r);
+}
+
+std::pair<BigInt, BigInt> divmod(const BigInt& number, const Divisor& divisor) {
+    const std::vector<int>& digits = BigIntAccess::digits(number);
+    std::vector<int> quotient(digits.size());
+    uint64_t r = 0;
+    for (std::size_t i = digits.size(); i-- > 0;) {
+        // r < |divisor|, so every quotient limb is below 10^9.
+        quotient[i] = static_cast<int>(divisor.step(&r, static_cast<uint32_t>(digits[i])));
+    }
+    const int sign = BigIntAccess::sign(number);
+    const int divisor_sign = divisor.value() < 0 ? -1 : 1;
+    BigInt remainder(r);
+    return {BigIntAccess::fromDigits(std::move(quotient), sign * divisor_sign),
+            sign < 0 ? -remainder : remainder};
+}
+
+BigInt operator/(const BigInt& number, const Divisor& divisor) {
+    return divmod(number, divisor).first;
+}
+
+BigInt operator%(const BigInt& number, const Divisor& divisor) {
+    return divisor.remainder(number);
+}
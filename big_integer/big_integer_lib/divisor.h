@@ -0,0 +1,36 @@
+#pragma once
+
+#include "big_int.h"
+#include <cstdint>
+#include <utility>
+
+/*
+    Precomputed reciprocal of a machine-size divisor. Dividing a BigInt by it walks the
+    base-10^9 limbs once and replaces each hardware division with the 2-by-1 reciprocal
+    division of Moller and Granlund ("Improved division by invariant integers", 2011), so
+    repeated divisions by the same constant run in linear time without a divide instruction.
+*/
+class Divisor {
+public:
+    explicit Divisor(int64_t divisor);
+
+    int64_t value() const;
+
+    // Remainder of number / divisor (sign of the dividend), without building the quotient.
+    int64_t remainder(const BigInt& number) const;
+
+    friend std::pair<BigInt, BigInt> divmod(const BigInt&, const Divisor&);  // NOLINT
+
+private:
+    int64_t value_;
+    uint64_t normalized_;  // |divisor| << shift_, with the top bit set
+    uint64_t reciprocal_;  // floor((2^128 - 1) / normalized_) - 2^64
+    int shift_;
+
+    // Divides r * 10^9 + limb by |divisor| for r < |divisor|; returns the quotient.
+    uint64_t step(uint64_t* r, uint32_t limb) const;
+};
+
+std::pair<BigInt, BigInt> divmod(const BigInt&, const Divisor&);  // NOLINT
+BigInt operator/(const BigInt&, const Divisor&);
+BigInt operator%(const BigInt&, const Divisor&);
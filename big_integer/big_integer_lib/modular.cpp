@@ -0,0 +1,372 @@
+#include "modular.h"
+#include "natural.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+using natural::Limbs;
+
+std::size_t trailingZeros(const Limbs& x) {
+    std::size_t bits = 0;
+    std::size_t i = 0;
+    for (; !x[i]; ++i) {
+        bits += 32;
+    }
+    for (uint32_t limb = x[i]; !(limb & 1); limb >>= 1) {
+        ++bits;
+    }
+    return bits;
+}
+
+// x mod 2^bits.
+void truncate(Limbs* x, std::size_t bits) {
+    const std::size_t limbs = (bits + 31) / 32;
+    if (x->size() > limbs) {
+        x->resize(limbs);
+    }
+    if (x->size() == limbs && bits % 32) {
+        x->back() &= (uint32_t(1) << (bits % 32)) - 1;
+    }
+    natural::normalize(x);
+}
+
+// a * b mod 2^bits; only the low product limbs are computed.
+Limbs mulLow(const Limbs& a, const Limbs& b, std::size_t bits) {
+    const std::size_t limbs = (bits + 31) / 32;
+    Limbs result(limbs);
+    for (std::size_t i = 0; i < a.size() && i < limbs; ++i) {
+        uint64_t carry = 0;
+        for (std::size_t j = 0; j < b.size() && i + j < limbs; ++j) {
+            carry += static_cast<uint64_t>(a[i]) * b[j] + result[i + j];
+            result[i + j] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        if (i + b.size() < limbs) {
+            result[i + b.size()] = static_cast<uint32_t>(carry);
+        }
+    }
+    truncate(&result, bits);
+    return result;
+}
+
+// (a - b) mod 2^bits for a, b < 2^bits.
+Limbs subLow(const Limbs& a, const Limbs& b, std::size_t bits) {
+    const std::size_t limbs = (bits + 31) / 32;
+    Limbs result(limbs);
+    uint64_t borrow = 0;
+    for (std::size_t i = 0; i < limbs; ++i) {
+        const uint64_t cur = static_cast<uint64_t>(i < a.size() ? a[i] : 0) -
+                             (i < b.size() ? b[i] : 0) - borrow;
+        result[i] = static_cast<uint32_t>(cur);
+        borrow = (cur >> 32) & 1;
+    }
+    truncate(&result, bits);
+    return result;
+}
+
+// odd^{-1} mod 2^bits by Newton iteration; each step doubles the number of correct bits.
+Limbs inverseLow(const Limbs& odd, std::size_t bits) {
+    Limbs inverse = {~natural::negativeInverse(odd[0]) + 1};
+    const Limbs two = {2};
+    for (std::size_t precision = 32; precision < bits; precision *= 2) {
+        const std::size_t next = std::min(2 * precision, bits);
+        inverse = mulLow(inverse, subLow(two, mulLow(odd, inverse, next), next), next);
+    }
+    truncate(&inverse, bits);
+    return inverse;
+}
+
+// base^exponent mod 2^bits by left-to-right binary exponentiation.
+Limbs powLow(Limbs base, const Limbs& exponent, std::size_t bits) {
+    truncate(&base, bits);
+    Limbs result = {1};
+    truncate(&result, bits);
+    for (std::size_t i = natural::bitLength(exponent); i-- > 0;) {
+        result = mulLow(result, result, bits);
+        if ((exponent[i / 32] >> (i % 32)) & 1) {
+            result = mulLow(result, base, bits);
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+BigInt powmod(const BigInt& base, const BigInt& exponent, const BigInt& modulus) {
+    if (modulus == 0) {
+        throw std::domain_error("powmod: zero modulus");
+    }
+    if (exponent < 0) {
+        throw std::domain_error("powmod: negative exponent");
+    }
+    const Limbs m = BigIntAccess::magnitude(modulus);
+    const Limbs e = BigIntAccess::magnitude(exponent);
+    Limbs b;
+    natural::divmod(BigIntAccess::magnitude(base), m, nullptr, &b);
+    if (base < 0 && !b.empty()) {
+        b = natural::sub(m, b);
+    }
+
+    const std::size_t k = trailingZeros(m);
+    const Limbs odd = natural::shiftRight(m, k);
+    Limbs odd_result;
+    if (natural::compare(odd, {1}) != 0) {
+        natural::Montgomery context(odd);
+        Limbs reduced;
+        natural::divmod(b, odd, nullptr, &reduced);
+        odd_result = context.fromMontgomery(context.pow(context.toMontgomery(reduced), e));
+    }
+    if (k == 0) {
+        return BigIntAccess::make(odd_result, 1);
+    }
+
+    // x = odd_result + odd * ((low_result - odd_result) * odd^{-1} mod 2^k)
+    const Limbs low_result = powLow(b, e, k);
+    Limbs odd_low = odd_result;
+    truncate(&odd_low, k);
+    const Limbs t = mulLow(subLow(low_result, odd_low, k), inverseLow(odd, k), k);
+    return BigIntAccess::make(natural::add(odd_result, natural::mul(odd, t)), 1);
+}
+
+/*
+    Modulus
+*/
+
+Modulus::Modulus(const BigInt& modulus) : value_(modulus.abs()) {
+    if (modulus == 0) {
+        throw std::domain_error("Modulus: zero modulus");
+    }
+    modulus_ = BigIntAccess::magnitude(value_);
+    const std::size_t n = modulus_.size();
+    Limbs power(2 * n + 1);
+    power.back() = 1;
+    Limbs remainder;
+    natural::divmod(power, modulus_, &reciprocal_, &remainder);
+    if (modulus_[0] & 1) {
+        montgomery_ = std::make_unique<natural::Montgomery>(modulus_);
+    }
+    product_.resize(2 * n);
+    quotient_.resize(2 * n + 4);
+    remainder_.resize(n + 1);
+}
+
+Modulus::Modulus(const Modulus& other)
+    : value_(other.value_),
+      modulus_(other.modulus_),
+      reciprocal_(other.reciprocal_),
+      montgomery_(other.montgomery_ ? std::make_unique<natural::Montgomery>(*other.montgomery_)
+                                    : nullptr),
+      product_(other.product_),
+      quotient_(other.quotient_),
+      remainder_(other.remainder_) {
+}
+
+Modulus& Modulus::operator=(const Modulus& other) {
+    if (this != &other) {
+        Modulus copy(other);
+        std::swap(value_, copy.value_);
+        modulus_.swap(copy.modulus_);
+        reciprocal_.swap(copy.reciprocal_);
+        montgomery_.swap(copy.montgomery_);
+        product_.swap(copy.product_);
+        quotient_.swap(copy.quotient_);
+        remainder_.swap(copy.remainder_);
+    }
+    return *this;
+}
+
+Modulus::~Modulus() = default;
+
+const BigInt& Modulus::value() const {
+    return value_;
+}
+
+std::size_t Modulus::size() const {
+    return modulus_.size();
+}
+
+// Barrett reduction (Handbook of Applied Cryptography, 14.42) of x < 2^(64 n).
+void Modulus::barrett(const uint32_t* x, std::size_t length, uint32_t* out) const {
+    const std::size_t k = size();
+
+    // q3 = floor(floor(x / b^(k - 1)) * mu / b^(k + 1))
+    const std::size_t q1_size = length >= k - 1 ? length - (k - 1) : 0;
+    const std::size_t q2_size = q1_size + reciprocal_.size();
+    std::fill(quotient_.begin(), quotient_.begin() + q2_size, 0);
+    for (std::size_t i = 0; i < q1_size; ++i) {
+        uint64_t carry = 0;
+        for (std::size_t j = 0; j < reciprocal_.size(); ++j) {
+            carry += static_cast<uint64_t>(x[k - 1 + i]) * reciprocal_[j] + quotient_[i + j];
+            quotient_[i + j] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        quotient_[i + reciprocal_.size()] = static_cast<uint32_t>(carry);
+    }
+    const uint32_t* q3 = quotient_.data() + k + 1;
+    const std::size_t q3_size = q2_size > k + 1 ? q2_size - (k + 1) : 0;
+
+    // r = (x - q3 * m) mod b^(k + 1)
+    for (std::size_t i = 0; i <= k; ++i) {
+        remainder_[i] = i < length ? x[i] : 0;
+    }
+    for (std::size_t i = 0; i < q3_size && i <= k; ++i) {
+        uint64_t carry = 0;
+        uint64_t borrow = 0;
+        for (std::size_t j = 0; j < k && i + j <= k; ++j) {
+            carry += static_cast<uint64_t>(q3[i]) * modulus_[j];
+            const uint64_t cur =
+                static_cast<uint64_t>(remainder_[i + j]) - static_cast<uint32_t>(carry) - borrow;
+            remainder_[i + j] = static_cast<uint32_t>(cur);
+            borrow = (cur >> 32) & 1;
+            carry >>= 32;
+        }
+        for (std::size_t j = i + k; j <= k; ++j) {
+            const uint64_t cur = static_cast<uint64_t>(remainder_[j]) -
+                                 static_cast<uint32_t>(carry) - borrow;
+            remainder_[j] = static_cast<uint32_t>(cur);
+            borrow = (cur >> 32) & 1;
+            carry >>= 32;
+        }
+    }
+
+    // At most two subtractions of m remain.
+    for (;;) {
+        bool less = remainder_[k] == 0;
+        if (less) {
+            less = false;
+            for (std::size_t i = k; i-- > 0;) {
+                if (remainder_[i] != modulus_[i]) {
+                    less = remainder_[i] < modulus_[i];
+                    break;
+                }
+            }
+        }
+        if (less) {
+            break;
+        }
+        uint64_t borrow = 0;
+        for (std::size_t i = 0; i <= k; ++i) {
+            const uint64_t cur =
+                static_cast<uint64_t>(remainder_[i]) - (i < k ? modulus_[i] : 0) - borrow;
+            remainder_[i] = static_cast<uint32_t>(cur);
+            borrow = (cur >> 32) & 1;
+        }
+    }
+    std::copy(remainder_.begin(), remainder_.begin() + k, out);
+}
+
+void Modulus::mulPlain(const uint32_t* a, const uint32_t* b, uint32_t* out) const {
+    const std::size_t n = size();
+    std::fill(product_.begin(), product_.end(), 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        uint64_t carry = 0;
+        for (std::size_t j = 0; j < n; ++j) {
+            carry += static_cast<uint64_t>(a[i]) * b[j] + product_[i + j];
+            product_[i + j] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        product_[i + n] = static_cast<uint32_t>(carry);
+    }
+    barrett(product_.data(), 2 * n, out);
+}
+
+// Least non-negative residue of x, reduced n limbs at a time from the top.
+Modulus::Residue Modulus::plainResidue(const BigInt& x) const {
+    const std::size_t n = size();
+    const Limbs magnitude = BigIntAccess::magnitude(x);
+    Residue result(n);
+    Limbs window(2 * n);
+    std::size_t top = magnitude.size();
+    while (top > 0) {
+        const std::size_t chunk = std::min(top, top % n ? top % n : n);
+        std::fill(window.begin(), window.end(), 0);
+        std::copy(magnitude.begin() + (top - chunk), magnitude.begin() + top, window.begin());
+        for (std::size_t i = 0; i < n; ++i) {
+            window[chunk + i] = result[i];
+        }
+        barrett(window.data(), chunk + n, result.data());
+        top -= chunk;
+    }
+    if (x < 0 && !natural::isZero(result)) {
+        natural::subMod(zero().data(), result.data(), modulus_, result.data());
+    }
+    return result;
+}
+
+Modulus::Residue Modulus::toResidue(const BigInt& x) const {
+    Residue result = plainResidue(x);
+    return montgomery_ ? montgomery_->toMontgomery(result) : result;
+}
+
+BigInt Modulus::fromResidue(const Residue& residue) const {
+    return BigIntAccess::make(montgomery_ ? montgomery_->fromMontgomery(residue) : residue, 1);
+}
+
+Modulus::Residue Modulus::zero() const {
+    return Residue(size());
+}
+
+Modulus::Residue Modulus::one() const {
+    return toResidue(1);
+}
+
+void Modulus::mul(const Residue& a, const Residue& b, Residue* out) const {
+    out->resize(size());
+    if (montgomery_) {
+        montgomery_->multiply(a.data(), b.data(), out->data());
+    } else {
+        mulPlain(a.data(), b.data(), out->data());
+    }
+}
+
+void Modulus::add(const Residue& a, const Residue& b, Residue* out) const {
+    out->resize(size());
+    natural::addMod(a.data(), b.data(), modulus_, out->data());
+}
+
+void Modulus::sub(const Residue& a, const Residue& b, Residue* out) const {
+    out->resize(size());
+    natural::subMod(a.data(), b.data(), modulus_, out->data());
+}
+
+BigInt Modulus::reduce(const BigInt& x) const {
+    return BigIntAccess::make(plainResidue(x), 1);
+}
+
+BigInt Modulus::mulmod(const BigInt& a, const BigInt& b) const {
+    Residue result = plainResidue(a);
+    mulPlain(result.data(), plainResidue(b).data(), result.data());
+    return BigIntAccess::make(result, 1);
+}
+
+BigInt Modulus::addmod(const BigInt& a, const BigInt& b) const {
+    Residue result = plainResidue(a);
+    natural::addMod(result.data(), plainResidue(b).data(), modulus_, result.data());
+    return BigIntAccess::make(result, 1);
+}
+
+BigInt Modulus::submod(const BigInt& a, const BigInt& b) const {
+    Residue result = plainResidue(a);
+    natural::subMod(result.data(), plainResidue(b).data(), modulus_, result.data());
+    return BigIntAccess::make(result, 1);
+}
+
+BigInt Modulus::powmod(const BigInt& base, const BigInt& exponent) const {
+    if (exponent < 0) {
+        throw std::domain_error("powmod: negative exponent");
+    }
+    const Limbs e = BigIntAccess::magnitude(exponent);
+    if (montgomery_) {
+        return fromResidue(montgomery_->pow(toResidue(base), e));
+    }
+    const Residue b = plainResidue(base);
+    Residue result = plainResidue(1);
+    for (std::size_t i = natural::bitLength(e); i-- > 0;) {
+        mulPlain(result.data(), result.data(), result.data());
+        if ((e[i / 32] >> (i % 32)) & 1) {
+            mulPlain(result.data(), b.data(), result.data());
+        }
+    }
+    return BigIntAccess::make(result, 1);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "big_int.h"
+#include "natural.h"
+#include <memory>
+
+/*
+    Modular arithmetic. Results are the least non-negative residues modulo |modulus|.
+*/
+
+// base^exponent mod modulus. Odd moduli use Montgomery multiplication, so the exponentiation
+// loop performs no divisions; for an even modulus m = 2^k * q the residues modulo q and 2^k are
+// computed separately and combined with the Chinese remainder theorem.
+BigInt powmod(const BigInt& base, const BigInt& exponent, const BigInt& modulus);  // NOLINT
+
+/*
+    Reduction context for a fixed modulus. The Barrett reciprocal and, for odd moduli, the
+    Montgomery constants are computed once in the constructor, so every later reduction costs a
+    couple of multiplications instead of a long division.
+
+    The Residue API works on preallocated fixed-size buffers (in Montgomery form for odd moduli)
+    and does not allocate; the BigInt overloads are conveniences that convert on every call. A
+    context owns scratch space and must not be used from several threads at once.
+*/
+class Modulus {
+public:
+    using Residue = natural::Limbs;  // exactly size() limbs
+
+    explicit Modulus(const BigInt& modulus);
+    Modulus(const Modulus&);
+    Modulus& operator=(const Modulus&);
+    ~Modulus();
+
+    const BigInt& value() const;
+    std::size_t size() const;
+
+    Residue toResidue(const BigInt&) const;
+    BigInt fromResidue(const Residue&) const;
+    Residue zero() const;
+    Residue one() const;
+    void mul(const Residue& a, const Residue& b, Residue* out) const;  // out may alias a or b
+    void add(const Residue& a, const Residue& b, Residue* out) const;
+    void sub(const Residue& a, const Residue& b, Residue* out) const;
+
+    BigInt reduce(const BigInt&) const;                     // NOLINT
+    BigInt mulmod(const BigInt&, const BigInt&) const;      // NOLINT
+    BigInt addmod(const BigInt&, const BigInt&) const;      // NOLINT
+    BigInt submod(const BigInt&, const BigInt&) const;      // NOLINT
+    BigInt powmod(const BigInt&, const BigInt&) const;      // NOLINT
+
+private:
+    BigInt value_;
+    natural::Limbs modulus_;
+    natural::Limbs reciprocal_;  // floor(2^(64 n) / m)
+    std::unique_ptr<natural::Montgomery> montgomery_;
+    mutable natural::Limbs product_;
+    mutable natural::Limbs quotient_;
+    mutable natural::Limbs remainder_;
+
+    void barrett(const uint32_t* x, std::size_t length, uint32_t* out) const;
+    void mulPlain(const uint32_t* a, const uint32_t* b, uint32_t* out) const;
+    Residue plainResidue(const BigInt&) const;
+};
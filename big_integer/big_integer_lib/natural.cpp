@@ -0,0 +1,512 @@
+#include "natural.h"
+#include "budget.h"
+#include <algorithm>
+
+namespace natural {
+
+namespace {
+
+const uint32_t kDecimalBase = 1000000000;
+
+// x = x * factor + addend.
+void mulAddSmall(Limbs* x, uint32_t factor, uint32_t addend) {
+    uint64_t carry = addend;
+    for (uint32_t& limb : *x) {
+        carry += static_cast<uint64_t>(limb) * factor;
+        limb = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    if (carry) {
+        x->push_back(static_cast<uint32_t>(carry));
+    }
+}
+
+// x = x / divisor; returns the remainder.
+uint32_t divSmall(Limbs* x, uint32_t divisor) {
+    uint64_t remainder = 0;
+    for (std::size_t i = x->size(); i-- > 0;) {
+        uint64_t cur = (remainder << 32) | (*x)[i];
+        (*x)[i] = static_cast<uint32_t>(cur / divisor);
+        remainder = cur % divisor;
+    }
+    normalize(x);
+    return static_cast<uint32_t>(remainder);
+}
+
+int leadingZeros(uint32_t value) {
+    int count = 0;
+    for (uint32_t bit = 0x80000000u; bit && !(value & bit); bit >>= 1) {
+        ++count;
+    }
+    return count;
+}
+
+bool testBit(const Limbs& x, std::size_t bit) {
+    return (x[bit / 32] >> (bit % 32)) & 1;
+}
+
+}  // namespace
+
+void normalize(Limbs* x) {
+    while (!x->empty() && !x->back()) {
+        x->pop_back();
+    }
+}
+
+bool isZero(const Limbs& x) {
+    for (uint32_t limb : x) {
+        if (limb) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int compare(const Limbs& a, const Limbs& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (std::size_t i = a.size(); i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+std::size_t bitLength(const Limbs& x) {
+    if (x.empty()) {
+        return 0;
+    }
+    return 32 * x.size() - leadingZeros(x.back());
+}
+
+Limbs fromUint64(uint64_t value) {
+    Limbs result = {static_cast<uint32_t>(value), static_cast<uint32_t>(value >> 32)};
+    normalize(&result);
+    return result;
+}
+
+Limbs fromDecimal(const std::vector<int>& digits) {
+    Limbs result;
+    result.reserve(digits.size());
+    for (std::size_t i = digits.size(); i-- > 0;) {
+        if (i % 64 == 63) {
+            BudgetScope::checkpoint();
+        }
+        mulAddSmall(&result, kDecimalBase, static_cast<uint32_t>(digits[i]));
+    }
+    return result;
+}
+
+std::vector<int> toDecimal(Limbs x) {
+    std::vector<int> digits;
+    normalize(&x);
+    while (!x.empty()) {
+        if (digits.size() % 64 == 63) {
+            BudgetScope::checkpoint();
+        }
+        digits.push_back(static_cast<int>(divSmall(&x, kDecimalBase)));
+    }
+    return digits;
+}
+
+Limbs add(const Limbs& a, const Limbs& b) {
+    const Limbs& longer = a.size() >= b.size() ? a : b;
+    const Limbs& shorter = a.size() >= b.size() ? b : a;
+    Limbs result(longer.size() + 1);
+    uint64_t carry = 0;
+    for (std::size_t i = 0; i < longer.size(); ++i) {
+        carry += static_cast<uint64_t>(longer[i]) + (i < shorter.size() ? shorter[i] : 0);
+        result[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    result[longer.size()] = static_cast<uint32_t>(carry);
+    normalize(&result);
+    return result;
+}
+
+Limbs sub(const Limbs& a, const Limbs& b) {
+    Limbs result(a.size());
+    uint64_t borrow = 0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        uint64_t cur = static_cast<uint64_t>(a[i]) - (i < b.size() ? b[i] : 0) - borrow;
+        result[i] = static_cast<uint32_t>(cur);
+        borrow = (cur >> 32) & 1;
+    }
+    normalize(&result);
+    return result;
+}
+
+Limbs mul(const Limbs& a, const Limbs& b) {
+    if (a.empty() || b.empty()) {
+        return {};
+    }
+    Limbs result(a.size() + b.size());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (i % 64 == 63) {
+            BudgetScope::checkpoint();
+        }
+        uint64_t carry = 0;
+        for (std::size_t j = 0; j < b.size(); ++j) {
+            carry += static_cast<uint64_t>(a[i]) * b[j] + result[i + j];
+            result[i + j] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        result[i + b.size()] = static_cast<uint32_t>(carry);
+    }
+    normalize(&result);
+    return result;
+}
+
+Limbs shiftLeft(const Limbs& x, std::size_t bits) {
+    if (x.empty()) {
+        return {};
+    }
+    const std::size_t limbs = bits / 32;
+    const int shift = static_cast<int>(bits % 32);
+    Limbs result(x.size() + limbs + 1);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        result[i + limbs] |= x[i] << shift;
+        if (shift) {
+            result[i + limbs + 1] = x[i] >> (32 - shift);
+        }
+    }
+    normalize(&result);
+    return result;
+}
+
+Limbs shiftRight(const Limbs& x, std::size_t bits) {
+    const std::size_t limbs = bits / 32;
+    const int shift = static_cast<int>(bits % 32);
+    if (limbs >= x.size()) {
+        return {};
+    }
+    Limbs result(x.size() - limbs);
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        result[i] = x[i + limbs] >> shift;
+        if (shift && i + limbs + 1 < x.size()) {
+            result[i] |= x[i + limbs + 1] << (32 - shift);
+        }
+    }
+    normalize(&result);
+    return result;
+}
+
+// Knuth's algorithm D (The Art of Computer Programming, 4.3.1).
+void divmod(const Limbs& u, const Limbs& v, Limbs* q, Limbs* r) {
+    const std::size_t n = v.size();
+    const std::size_t m = u.size();
+    if (compare(u, v) < 0) {
+        if (q != nullptr) {
+            q->clear();
+        }
+        *r = u;
+        return;
+    }
+    if (n == 1) {
+        Limbs quotient = u;
+        const uint32_t remainder = divSmall(&quotient, v[0]);
+        *r = fromUint64(remainder);
+        if (q != nullptr) {
+            *q = std::move(quotient);
+        }
+        return;
+    }
+
+    const int shift = leadingZeros(v[n - 1]);
+    Limbs vn(n), un(m + 1);
+    for (std::size_t i = n - 1; i > 0; --i) {
+        vn[i] = shift ? (v[i] << shift) | (v[i - 1] >> (32 - shift)) : v[i];
+    }
+    vn[0] = v[0] << shift;
+    un[m] = shift ? u[m - 1] >> (32 - shift) : 0;
+    for (std::size_t i = m - 1; i > 0; --i) {
+        un[i] = shift ? (u[i] << shift) | (u[i - 1] >> (32 - shift)) : u[i];
+    }
+    un[0] = u[0] << shift;
+
+    Limbs quotient(m - n + 1);
+    const uint64_t radix = uint64_t(1) << 32;
+    for (std::size_t j = m - n + 1; j-- > 0;) {
+        if (j % 64 == 63) {
+            BudgetScope::checkpoint();
+        }
+        const uint64_t numerator = (static_cast<uint64_t>(un[j + n]) << 32) | un[j + n - 1];
+        uint64_t qhat = numerator / vn[n - 1];
+        uint64_t rhat = numerator % vn[n - 1];
+        while (qhat >= radix || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+            --qhat;
+            rhat += vn[n - 1];
+            if (rhat >= radix) {
+                break;
+            }
+        }
+
+        int64_t borrow = 0;
+        int64_t t = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const uint64_t product = qhat * vn[i];
+            t = static_cast<int64_t>(un[i + j]) - borrow -
+                static_cast<int64_t>(product & 0xFFFFFFFFu);
+            un[i + j] = static_cast<uint32_t>(t);
+            borrow = static_cast<int64_t>(product >> 32) - (t >> 32);
+        }
+        t = static_cast<int64_t>(un[j + n]) - borrow;
+        un[j + n] = static_cast<uint32_t>(t);
+
+        quotient[j] = static_cast<uint32_t>(qhat);
+        if (t < 0) {
+            --quotient[j];
+            uint64_t carry = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                carry += static_cast<uint64_t>(un[i + j]) + vn[i];
+                un[i + j] = static_cast<uint32_t>(carry);
+                carry >>= 32;
+            }
+            un[j + n] += static_cast<uint32_t>(carry);
+        }
+    }
+
+    r->assign(n, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        (*r)[i] = shift ? (un[i] >> shift) | (un[i + 1] << (32 - shift)) : un[i];
+    }
+    normalize(r);
+    if (q != nullptr) {
+        normalize(&quotient);
+        *q = std::move(quotient);
+    }
+}
+
+void addMod(const uint32_t* a, const uint32_t* b, const Limbs& m, uint32_t* out) {
+    const std::size_t n = m.size();
+    uint64_t carry = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        carry += static_cast<uint64_t>(a[i]) + b[i];
+        out[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    bool subtract = carry != 0;
+    if (!subtract) {
+        subtract = true;
+        for (std::size_t i = n; i-- > 0;) {
+            if (out[i] != m[i]) {
+                subtract = out[i] > m[i];
+                break;
+            }
+        }
+    }
+    if (subtract) {
+        uint64_t borrow = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const uint64_t cur = static_cast<uint64_t>(out[i]) - m[i] - borrow;
+            out[i] = static_cast<uint32_t>(cur);
+            borrow = (cur >> 32) & 1;
+        }
+    }
+}
+
+void subMod(const uint32_t* a, const uint32_t* b, const Limbs& m, uint32_t* out) {
+    const std::size_t n = m.size();
+    uint64_t borrow = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const uint64_t cur = static_cast<uint64_t>(a[i]) - b[i] - borrow;
+        out[i] = static_cast<uint32_t>(cur);
+        borrow = (cur >> 32) & 1;
+    }
+    if (borrow) {
+        uint64_t carry = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            carry += static_cast<uint64_t>(out[i]) + m[i];
+            out[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+    }
+}
+
+uint32_t negativeInverse(uint32_t m) {
+    uint32_t inverse = m;  // correct to 3 bits for odd m; each Newton step doubles that
+    for (int i = 0; i < 4; ++i) {
+        inverse *= 2 - m * inverse;
+    }
+    return ~inverse + 1;
+}
+
+/*
+    Montgomery
+*/
+
+Montgomery::Montgomery(const Limbs& modulus)
+    : modulus_(modulus), inverse_(negativeInverse(modulus.at(0))), scratch_(modulus.size() + 2) {
+    Limbs r_squared(2 * modulus_.size() + 1);
+    r_squared.back() = 1;
+    divmod(r_squared, modulus_, nullptr, &r2_);
+    r2_.resize(modulus_.size());
+}
+
+std::size_t Montgomery::size() const {
+    return modulus_.size();
+}
+
+const Limbs& Montgomery::modulus() const {
+    return modulus_;
+}
+
+Limbs Montgomery::toMontgomery(const Limbs& x) const {
+    Limbs result = x;
+    result.resize(size());
+    multiply(result.data(), r2_.data(), result.data());
+    return result;
+}
+
+Limbs Montgomery::fromMontgomery(const Limbs& x) const {
+    Limbs unit(size());
+    unit[0] = 1;
+    Limbs result(size());
+    multiply(x.data(), unit.data(), result.data());
+    normalize(&result);
+    return result;
+}
+
+Limbs Montgomery::one() const {
+    Limbs r(size() + 1);
+    r.back() = 1;
+    Limbs result;
+    divmod(r, modulus_, nullptr, &result);
+    result.resize(size());
+    return result;
+}
+
+// Coarsely integrated operand scanning (Koc, Acar, Kaliski, 1996).
+void Montgomery::multiply(const uint32_t* a, const uint32_t* b, uint32_t* out) const {
+    const std::size_t n = size();
+    uint32_t* t = scratch_.data();
+    std::fill(scratch_.begin(), scratch_.end(), 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        uint64_t carry = 0;
+        for (std::size_t j = 0; j < n; ++j) {
+            carry += static_cast<uint64_t>(a[j]) * b[i] + t[j];
+            t[j] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        carry += t[n];
+        t[n] = static_cast<uint32_t>(carry);
+        t[n + 1] = static_cast<uint32_t>(carry >> 32);
+
+        const uint32_t factor = t[0] * inverse_;
+        carry = (static_cast<uint64_t>(factor) * modulus_[0] + t[0]) >> 32;
+        for (std::size_t j = 1; j < n; ++j) {
+            carry += static_cast<uint64_t>(factor) * modulus_[j] + t[j];
+            t[j - 1] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        carry += t[n];
+        t[n - 1] = static_cast<uint32_t>(carry);
+        t[n] = t[n + 1] + static_cast<uint32_t>(carry >> 32);
+    }
+
+    bool subtract = t[n] != 0;
+    if (!subtract) {
+        subtract = true;
+        for (std::size_t i = n; i-- > 0;) {
+            if (t[i] != modulus_[i]) {
+                subtract = t[i] > modulus_[i];
+                break;
+            }
+        }
+    }
+    if (subtract) {
+        uint64_t borrow = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const uint64_t cur = static_cast<uint64_t>(t[i]) - modulus_[i] - borrow;
+            out[i] = static_cast<uint32_t>(cur);
+            borrow = (cur >> 32) & 1;
+        }
+    } else {
+        std::copy(t, t + n, out);
+    }
+}
+
+void Montgomery::add(const uint32_t* a, const uint32_t* b, uint32_t* out) const {
+    addMod(a, b, modulus_, out);
+}
+
+void Montgomery::sub(const uint32_t* a, const uint32_t* b, uint32_t* out) const {
+    subMod(a, b, modulus_, out);
+}
+
+Limbs Montgomery::pow(const Limbs& base, const Limbs& exponent) const {
+    const std::size_t bits = bitLength(exponent);
+    Limbs result = one();
+    if (bits == 0) {
+        return result;
+    }
+    const int window = bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : 1;
+
+    // table[i] = base^(2 i + 1)
+    std::vector<Limbs> table(std::size_t(1) << (window - 1), Limbs(size()));
+    table[0] = base;
+    Limbs square(size());
+    multiply(base.data(), base.data(), square.data());
+    for (std::size_t i = 1; i < table.size(); ++i) {
+        multiply(table[i - 1].data(), square.data(), table[i].data());
+    }
+
+    bool started = false;
+    for (std::size_t i = bits; i-- > 0;) {
+        if (!testBit(exponent, i)) {
+            multiply(result.data(), result.data(), result.data());
+            continue;
+        }
+        std::size_t low = i >= static_cast<std::size_t>(window - 1) ? i - (window - 1) : 0;
+        while (!testBit(exponent, low)) {
+            ++low;
+        }
+        uint32_t value = 0;
+        for (std::size_t j = i + 1; j-- > low;) {
+            value = (value << 1) | static_cast<uint32_t>(testBit(exponent, j));
+            if (started) {
+                multiply(result.data(), result.data(), result.data());
+            }
+        }
+        if (started) {
+            multiply(result.data(), table[value >> 1].data(), result.data());
+        } else {
+            result = table[value >> 1];
+            started = true;
+        }
+        i = low;
+    }
+    return result;
+}
+
+}  // namespace natural
+
+/*
+    BigIntAccess
+*/
+
+natural::Limbs BigIntAccess::magnitude(const BigInt& number) {
+    return natural::fromDecimal(number.digits_);
+}
+
+int BigIntAccess::sign(const BigInt& number) {
+    return number.digits_.empty() ? 0 : number.sign_;
+}
+
+BigInt BigIntAccess::make(const natural::Limbs& magnitude, int sign) {
+    return fromDigits(natural::toDecimal(magnitude), sign);
+}
+
+const std::vector<int>& BigIntAccess::digits(const BigInt& number) {
+    return number.digits_;
+}
+
+BigInt BigIntAccess::fromDigits(std::vector<int> digits, int sign) {
+    BigInt result;
+    result.digits_ = std::move(digits);
+    result.sign_ = sign < 0 ? -1 : 1;
+    result.trim();
+    return result;
+}
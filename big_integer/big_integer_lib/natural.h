@@ -0,0 +1,81 @@
+#pragma once
+
+#include "big_int.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/*
+    Internal arithmetic on natural numbers stored as little-endian base-2^32 limbs. BigInt keeps
+    base-10^9 limbs so that printing stays cheap; the algorithms that depend on powers of two
+    (Montgomery reduction, bit operations, binary gcd) convert to this form once, do all their
+    work here and convert back at the end.
+*/
+namespace natural {
+
+using Limbs = std::vector<uint32_t>;  // no leading zero limbs unless stated otherwise
+
+void normalize(Limbs*);
+bool isZero(const Limbs&);
+int compare(const Limbs&, const Limbs&);
+std::size_t bitLength(const Limbs&);
+
+Limbs fromUint64(uint64_t);
+Limbs fromDecimal(const std::vector<int>& digits);  // base-10^9 limbs
+std::vector<int> toDecimal(Limbs);
+
+Limbs add(const Limbs&, const Limbs&);
+Limbs sub(const Limbs&, const Limbs&);  // requires a >= b
+Limbs mul(const Limbs&, const Limbs&);
+Limbs shiftLeft(const Limbs&, std::size_t bits);
+Limbs shiftRight(const Limbs&, std::size_t bits);
+void divmod(const Limbs& u, const Limbs& v, Limbs* q, Limbs* r);  // v != 0; q may be null
+
+// out = (a + b) mod m and out = (a - b) mod m for residues of exactly m.size() limbs.
+void addMod(const uint32_t* a, const uint32_t* b, const Limbs& m, uint32_t* out);
+void subMod(const uint32_t* a, const uint32_t* b, const Limbs& m, uint32_t* out);
+
+// -m^{-1} mod 2^32 for odd m.
+uint32_t negativeInverse(uint32_t m);
+
+/*
+    Montgomery arithmetic modulo an odd n-limb modulus m with R = 2^(32 n). Residues are kept as
+    exactly n limbs (possibly with leading zeros) so that every step works in place on
+    preallocated buffers. A context owns scratch space and must not be shared between threads.
+*/
+class Montgomery {
+public:
+    explicit Montgomery(const Limbs& modulus);
+
+    std::size_t size() const;
+    const Limbs& modulus() const;
+
+    Limbs toMontgomery(const Limbs& x) const;  // x < m
+    Limbs fromMontgomery(const Limbs& x) const;
+    Limbs one() const;  // R mod m, the Montgomery form of 1
+
+    // out = a * b / R mod m; out may alias a or b.
+    void multiply(const uint32_t* a, const uint32_t* b, uint32_t* out) const;
+    void add(const uint32_t* a, const uint32_t* b, uint32_t* out) const;
+    void sub(const uint32_t* a, const uint32_t* b, uint32_t* out) const;
+
+    // base^exponent for a base in Montgomery form, by sliding-window exponentiation.
+    Limbs pow(const Limbs& base, const Limbs& exponent) const;
+
+private:
+    Limbs modulus_;
+    Limbs r2_;  // R^2 mod m
+    uint32_t inverse_;
+    mutable Limbs scratch_;
+};
+
+}  // namespace natural
+
+// Bridge between BigInt's decimal limbs and the binary layer.
+struct BigIntAccess {
+    static natural::Limbs magnitude(const BigInt&);
+    static int sign(const BigInt&);
+    static BigInt make(const natural::Limbs& magnitude, int sign);
+    static const std::vector<int>& digits(const BigInt&);
+    static BigInt fromDigits(std::vector<int> digits, int sign);
+};
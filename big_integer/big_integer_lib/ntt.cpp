@@ -0,0 +1,283 @@
+#include "ntt.h"
+#include "budget.h"
+#include "natural.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace ntt {
+
+namespace {
+
+const uint64_t kDecimalBase = 1000000000;
+
+// The transform primes, c * 2^k + 1 with k >= 23; 3 generates the multiplicative group of each.
+const uint32_t kP1 = 998244353;  // 119 * 2^23 + 1
+const uint32_t kP2 = 167772161;  // 5 * 2^25 + 1
+const uint32_t kP3 = 469762049;  // 7 * 2^26 + 1
+
+uint32_t powMod(uint64_t base, uint64_t exponent, uint32_t p) {
+    uint64_t result = 1;
+    for (base %= p; exponent; exponent >>= 1) {
+        if (exponent & 1) {
+            result = result * base % p;
+        }
+        base = base * base % p;
+    }
+    return static_cast<uint32_t>(result);
+}
+
+// Arithmetic modulo a prime p < 2^30 on Montgomery representatives x * 2^32 mod p, so the
+// butterflies reduce their products without a division.
+class Field {
+public:
+    Field(uint32_t p, uint32_t generator)
+        : p_(p),
+          generator_(generator),
+          inverse_(natural::negativeInverse(p)),
+          r_squared_(powMod(2, 64, p)) {
+    }
+
+    uint32_t prime() const {
+        return p_;
+    }
+
+    uint32_t add(uint32_t a, uint32_t b) const {
+        const uint32_t sum = a + b;
+        return sum >= p_ ? sum - p_ : sum;
+    }
+
+    uint32_t sub(uint32_t a, uint32_t b) const {
+        return a >= b ? a - b : a + p_ - b;
+    }
+
+    uint32_t mul(uint32_t a, uint32_t b) const {
+        return reduce(static_cast<uint64_t>(a) * b);
+    }
+
+    uint32_t toMontgomery(uint32_t x) const {  // any x < 2^32
+        return mul(x, r_squared_);
+    }
+
+    uint32_t fromMontgomery(uint32_t a) const {
+        return reduce(a);
+    }
+
+    // roots[half + j] = w^j for the primitive (2 half)-th root of unity w, or its inverse, for
+    // every half = 1, 2, 4, ..., n / 2; in Montgomery form.
+    std::vector<uint32_t> roots(std::size_t n, bool inverse) const {
+        std::vector<uint32_t> roots(std::max<std::size_t>(n, 2));
+        for (std::size_t half = 1; half < n; half *= 2) {
+            const uint64_t exponent = (p_ - 1) / (2 * half);
+            const uint32_t w = powMod(generator_, inverse ? p_ - 1 - exponent : exponent, p_);
+            const uint32_t step = toMontgomery(w);
+            roots[half] = toMontgomery(1);
+            for (std::size_t j = 1; j < half; ++j) {
+                roots[half + j] = mul(roots[half + j - 1], step);
+            }
+        }
+        return roots;
+    }
+
+private:
+    uint32_t p_;
+    uint32_t generator_;
+    uint32_t inverse_;  // -p^-1 mod 2^32
+    uint32_t r_squared_;
+
+    // x * 2^-32 mod p for x < p * 2^32.
+    uint32_t reduce(uint64_t x) const {
+        const uint32_t m = static_cast<uint32_t>(x) * inverse_;
+        const uint32_t t = static_cast<uint32_t>((x + static_cast<uint64_t>(m) * p_) >> 32);
+        return t >= p_ ? t - p_ : t;
+    }
+};
+
+// Decimation in frequency: natural order in, bit-reversed order out.
+void forward(uint32_t* x, std::size_t n, const std::vector<uint32_t>& roots, const Field& field) {
+    for (std::size_t half = n / 2; half >= 1; half /= 2) {
+        BudgetScope::checkpoint();
+        for (std::size_t start = 0; start < n; start += 2 * half) {
+            for (std::size_t j = 0; j < half; ++j) {
+                const uint32_t u = x[start + j];
+                const uint32_t v = x[start + j + half];
+                x[start + j] = field.add(u, v);
+                x[start + j + half] = field.mul(field.sub(u, v), roots[half + j]);
+            }
+        }
+    }
+}
+
+// Decimation in time with the inverse roots: bit-reversed order in, natural order out, scaled
+// by n.
+void inverse(uint32_t* x, std::size_t n, const std::vector<uint32_t>& roots, const Field& field) {
+    for (std::size_t half = 1; half < n; half *= 2) {
+        BudgetScope::checkpoint();
+        for (std::size_t start = 0; start < n; start += 2 * half) {
+            for (std::size_t j = 0; j < half; ++j) {
+                const uint32_t u = x[start + j];
+                const uint32_t v = field.mul(x[start + j + half], roots[half + j]);
+                x[start + j] = field.add(u, v);
+                x[start + j + half] = field.sub(u, v);
+            }
+        }
+    }
+}
+
+// out[0, n) = the forward transform of digits[begin, end), zero-padded to n values.
+void transform(const std::vector<int>& digits, std::size_t begin, std::size_t end, std::size_t n,
+               const std::vector<uint32_t>& roots, const Field& field, uint32_t* out) {
+    std::fill(out, out + n, 0);
+    for (std::size_t i = begin; i < end; ++i) {
+        out[i - begin] = field.toMontgomery(static_cast<uint32_t>(digits[i]));
+    }
+    forward(out, n, roots, field);
+}
+
+const Field& field(int index) {
+    static const Field kFields[3] = {{kP1, 3}, {kP2, 3}, {kP3, 3}};
+    return kFields[index];
+}
+
+// Adds the coefficients r1, r2, r3 (residues modulo the three primes) of a partial product to
+// result[offset, ...), propagating the carries as far as they go.
+//
+// Coefficient c = v1 + p1 (v2 + p2 v3) with v1 < p1, v2 < p2, v3 < p3. The inner sum t is
+// below p2 p3 < 2^57, and c = (v1 + p1 (t mod 10^9)) + p1 (t / 10^9) 10^9 keeps every partial
+// sum of the carry propagation within 64 bits.
+void accumulate(const std::vector<uint32_t>& r1, const std::vector<uint32_t>& r2,
+                const std::vector<uint32_t>& r3, std::size_t count, std::size_t offset,
+                std::vector<int>* result) {
+    static const uint64_t kInverseP1ModP2 = powMod(kP1, kP2 - 2, kP2);
+    static const uint64_t kInverseP1ModP3 = powMod(kP1, kP3 - 2, kP3);
+    static const uint64_t kInverseP2ModP3 = powMod(kP2, kP3 - 2, kP3);
+
+    int* limbs = result->data() + offset;
+    const std::size_t available = result->size() - offset;
+    uint64_t carry = 0;
+    for (std::size_t i = 0; i < available && (i < count || carry); ++i) {
+        uint64_t low = carry + static_cast<uint64_t>(limbs[i]);
+        carry = 0;
+        if (i < count) {
+            const uint64_t v1 = r1[i];
+            const uint64_t v2 = (r2[i] + kP2 - v1 % kP2) * kInverseP1ModP2 % kP2;
+            const uint64_t u3 = (r3[i] + kP3 - v1 % kP3) * kInverseP1ModP3 % kP3;
+            const uint64_t v3 = (u3 + kP3 - v2) * kInverseP2ModP3 % kP3;
+            const uint64_t t = v2 + kP2 * v3;
+            low += v1 + kP1 * (t % kDecimalBase);
+            carry = kP1 * (t / kDecimalBase);
+        }
+        limbs[i] = static_cast<int>(low % kDecimalBase);
+        carry += low / kDecimalBase;
+    }
+}
+
+std::size_t ceilPowerOfTwo(std::size_t size) {
+    std::size_t n = 1;
+    while (n < size) {
+        n *= 2;
+    }
+    return n;
+}
+
+}  // namespace
+
+std::size_t transformLength(std::size_t shorter, std::size_t longer) {
+    const std::size_t cap = std::size_t(1) << 23;
+    std::size_t n = 1;
+    while (n < shorter + longer - 1 && n < 4 * shorter && n < cap) {
+        n *= 2;
+    }
+    return n;
+}
+
+Transformed::Transformed(const std::vector<int>& digits, std::size_t length, std::size_t chunk)
+    : length_(length),
+      chunk_(std::min(chunk, digits.size())),
+      limbs_(digits.size()) {
+    const std::size_t count = chunks();
+    for (int p = 0; p < 3; ++p) {
+        const std::vector<uint32_t> roots = field(p).roots(length_, false);
+        residues_[p].resize(count * length_);
+        for (std::size_t i = 0; i < count; ++i) {
+            transform(digits, i * chunk_, std::min(limbs_, (i + 1) * chunk_), length_, roots,
+                      field(p), residues_[p].data() + i * length_);
+        }
+    }
+}
+
+std::size_t Transformed::length() const {
+    return length_;
+}
+
+std::size_t Transformed::chunk() const {
+    return chunk_;
+}
+
+std::size_t Transformed::chunks() const {
+    return chunk_ ? (limbs_ + chunk_ - 1) / chunk_ : 0;
+}
+
+std::size_t Transformed::limbs() const {
+    return limbs_;
+}
+
+std::vector<int> multiply(const Transformed& a, const Transformed& b) {
+    if (!a.chunks() || !b.chunks()) {
+        return {};
+    }
+    // Let `whole` be the factor in a single chunk and `cut` the other one.
+    const Transformed& whole = a.chunks() == 1 ? a : b;
+    const Transformed& cut = &whole == &a ? b : a;
+    const std::size_t n = whole.length();
+
+    std::vector<int> product(a.limbs() + b.limbs());
+    std::vector<uint32_t> inverse_roots[3];
+    uint32_t scale[3];
+    for (int p = 0; p < 3; ++p) {
+        inverse_roots[p] = field(p).roots(n, true);
+        // n divides p - 1, so n^-1 = p - (p - 1) / n.
+        const uint32_t prime = field(p).prime();
+        scale[p] = field(p).toMontgomery(prime - (prime - 1) / static_cast<uint32_t>(n));
+    }
+    std::vector<uint32_t> residues[3];
+    for (std::size_t i = 0; i < cut.chunks(); ++i) {
+        for (int p = 0; p < 3; ++p) {
+            const Field& f = field(p);
+            const uint32_t* x = whole.residues_[p].data();
+            const uint32_t* y = cut.residues_[p].data() + i * n;
+            std::vector<uint32_t>& r = residues[p];
+            r.resize(n);
+            for (std::size_t k = 0; k < n; ++k) {
+                r[k] = f.mul(x[k], y[k]);
+            }
+            inverse(r.data(), n, inverse_roots[p], f);
+            for (uint32_t& value : r) {
+                value = f.fromMontgomery(f.mul(value, scale[p]));
+            }
+        }
+        const std::size_t chunk_limbs = std::min(cut.chunk(), cut.limbs() - i * cut.chunk());
+        accumulate(residues[0], residues[1], residues[2], whole.limbs() + chunk_limbs - 1,
+                   i * cut.chunk(), &product);
+    }
+    while (!product.empty() && !product.back()) {
+        product.pop_back();
+    }
+    return product;
+}
+
+std::vector<int> multiply(const std::vector<int>& a, const std::vector<int>& b) {
+    if (a.empty() || b.empty()) {
+        return {};
+    }
+    if (&a == &b) {
+        const Transformed square(a, ceilPowerOfTwo(2 * a.size() - 1), a.size());
+        return multiply(square, square);
+    }
+    const std::vector<int>& shorter = a.size() <= b.size() ? a : b;
+    const std::vector<int>& longer = &shorter == &a ? b : a;
+    const std::size_t n = transformLength(shorter.size(), longer.size());
+    return multiply(Transformed(shorter, n, shorter.size()),
+                    Transformed(longer, n, n - shorter.size() + 1));
+}
+
+}  // namespace ntt
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+    Internal multiplication of base-10^9 limb vectors by number-theoretic transforms. The limbs
+    are transformed modulo three primes below 2^30 with 2^23 | p - 1, multiplied pointwise and
+    transformed back; the exact coefficients, below 2^22 * 10^18 < p1 p2 p3, are recovered by
+    Garner's mixed-radix CRT while the carries are propagated. The cost is O(n log n), which
+    overtakes Karatsuba from a few thousand limbs on.
+
+    The transform length follows the shorter factor, not the product: the longer factor is cut
+    into chunks that fit next to the shorter one, and each chunk costs one forward and one
+    inverse transform per prime against the shorter factor's transform, which is made once.
+*/
+namespace ntt {
+
+// Longest factor whose transform fits, in limbs; the other factor may be of any length.
+const std::size_t kMaxFactorLimbs = std::size_t(1) << 22;
+
+// The power-of-two transform length for a factor of `shorter` limbs times one of `longer`:
+// the whole product if it is short, otherwise room for chunks of the longer factor of at least
+// three times the shorter one. shorter <= kMaxFactorLimbs.
+std::size_t transformLength(std::size_t shorter, std::size_t longer);
+
+// The forward transforms of a factor, cut into chunks of `chunk` limbs, at a transform length.
+// Built once, they serve any number of products; the memory is 12 bytes per transform value.
+class Transformed {
+public:
+    Transformed(const std::vector<int>& digits, std::size_t length, std::size_t chunk);
+
+    std::size_t length() const;
+    std::size_t chunk() const;    // limbs per chunk; the factor's length if it is not cut
+    std::size_t chunks() const;   // number of chunks, 0 for a zero factor
+    std::size_t limbs() const;
+
+private:
+    std::size_t length_;
+    std::size_t chunk_;
+    std::size_t limbs_;
+    std::vector<uint32_t> residues_[3];  // chunks() transforms of length_ per prime
+
+    friend std::vector<int> multiply(const Transformed& a, const Transformed& b);
+};
+
+// The product of two transformed factors of the same length, one of them in a single chunk,
+// with a.chunk() + b.chunk() - 1 <= length. Little-endian base-10^9 limbs, no leading zeros.
+// Passing the same object twice squares it.
+std::vector<int> multiply(const Transformed& a, const Transformed& b);
+
+// a * b for little-endian base-10^9 limbs; the shorter one has at most kMaxFactorLimbs. The
+// result has no leading zero limbs. Passing the same vector twice squares it with one forward
+// transform instead of two.
+std::vector<int> multiply(const std::vector<int>& a, const std::vector<int>& b);
+
+}  // namespace ntt
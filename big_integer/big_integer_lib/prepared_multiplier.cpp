@@ -0,0 +1,177 @@
+#include "prepared_multiplier.h"
+#include "budget.h"
+#include "tuning.h"
+#include <algorithm>
+
+namespace {
+
+// Digits are added and multiplied modulo 2^64. Sums of digits grow by a bit per level and
+// their products may wrap, but every coefficient of the final product is below 2^63, so the
+// wrapped arithmetic gives it exactly.
+
+// Number of values in the evaluation of a block of `size` digits.
+std::size_t evaluationSize(std::size_t size, std::size_t leaf) {
+    return size <= leaf ? size : 3 * evaluationSize(size / 2, leaf);
+}
+
+// Appends the evaluation of a[0, size): the leaves of the low half, of the high half and of
+// their sum.
+void evaluate(const uint64_t* a, std::size_t size, std::size_t leaf, std::vector<uint64_t>* out) {
+    if (size <= leaf) {
+        out->insert(out->end(), a, a + size);
+        return;
+    }
+    const std::size_t half = size / 2;
+    evaluate(a, half, leaf, out);
+    evaluate(a + half, half, leaf, out);
+    std::vector<uint64_t> sum(a, a + half);
+    for (std::size_t i = 0; i < half; ++i) {
+        sum[i] += a[half + i];
+    }
+    evaluate(sum.data(), half, leaf, out);
+}
+
+// Evaluations of the blocks of `size` digits, zero-padded, that make up `digits`.
+std::vector<std::vector<uint64_t>> evaluateBlocks(const std::vector<int>& digits,
+                                                  std::size_t size, std::size_t leaf) {
+    std::vector<std::vector<uint64_t>> blocks;
+    std::vector<uint64_t> block(size);
+    for (std::size_t begin = 0; begin < digits.size(); begin += size) {
+        const std::size_t end = std::min(digits.size(), begin + size);
+        std::fill(std::copy(digits.begin() + begin, digits.begin() + end, block.begin()),
+                  block.end(), 0);
+        blocks.emplace_back();
+        blocks.back().reserve(evaluationSize(size, leaf));
+        evaluate(block.data(), size, leaf, &blocks.back());
+    }
+    return blocks;
+}
+
+// Adds the product of two evaluated blocks of `size` digits to result[0, 2 size). `scratch`
+// holds 6 size values.
+void multiplyEvaluated(const uint64_t* a, const uint64_t* b, std::size_t size, std::size_t leaf,
+                       uint64_t* result, uint64_t* scratch) {
+    if (size <= leaf) {
+        for (std::size_t i = 0; i < size; ++i) {
+            for (std::size_t j = 0; j < size; ++j) {
+                result[i + j] += a[i] * b[j];
+            }
+        }
+        return;
+    }
+
+    BudgetScope::checkpoint();
+
+    const std::size_t half = size / 2;
+    const std::size_t part = evaluationSize(half, leaf);
+    uint64_t* low = scratch;
+    uint64_t* high = scratch + size;
+    uint64_t* middle = scratch + 2 * size;
+    std::fill(scratch, scratch + 3 * size, 0);
+    multiplyEvaluated(a, b, half, leaf, low, scratch + 3 * size);
+    multiplyEvaluated(a + part, b + part, half, leaf, high, scratch + 3 * size);
+    multiplyEvaluated(a + 2 * part, b + 2 * part, half, leaf, middle, scratch + 3 * size);
+    for (std::size_t i = 0; i < size; ++i) {
+        result[i] += low[i];
+        result[i + half] += middle[i] - low[i] - high[i];
+        result[i + size] += high[i];
+    }
+}
+
+}  // namespace
+
+PreparedMultiplier::PreparedMultiplier(const BigInt& value)
+    : value_(value),
+      digits_(BigInt::convertBase(value.digits_, BigInt::kBaseDigits, 6)),
+      leaf_(std::max(1, TuningProfile::active().karatsuba_base_case)) {
+}
+
+const BigInt& PreparedMultiplier::value() const {
+    return value_;
+}
+
+const std::vector<PreparedMultiplier::Evaluation>& PreparedMultiplier::blocks(
+    std::size_t size) const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto it = blocks_.find(size);
+    if (it == blocks_.end()) {
+        it = blocks_.emplace(size, evaluateBlocks(digits_, size, leaf_)).first;
+    }
+    return it->second;  // map nodes are stable and never modified once inserted
+}
+
+const ntt::Transformed& PreparedMultiplier::transforms(std::size_t length,
+                                                      std::size_t chunk) const {
+    const std::pair<std::size_t, std::size_t> key(length, std::min(chunk, value_.digits_.size()));
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto it = transforms_.find(key);
+    if (it == transforms_.end()) {
+        it = transforms_.emplace(key, ntt::Transformed(value_.digits_, length, key.second)).first;
+    }
+    return it->second;
+}
+
+BigInt PreparedMultiplier::multiply(const BigInt& other) const {
+    if (value_.digits_.empty() || other.digits_.empty()) {
+        return BigInt();
+    }
+    const std::size_t my_limbs = value_.digits_.size();
+    const std::size_t their_limbs = other.digits_.size();
+    const std::size_t shorter = std::min(my_limbs, their_limbs);
+    if (BigInt::multipliesByNtt(shorter, std::max(my_limbs, their_limbs))) {
+        // As in ntt::multiply: the shorter operand whole, the longer one in chunks.
+        const std::size_t length = ntt::transformLength(shorter, std::max(my_limbs, their_limbs));
+        const std::size_t chunk = length - shorter + 1;
+        const bool whole = my_limbs <= their_limbs;
+        BigInt result;
+        result.sign_ = value_.sign_ * other.sign_;
+        result.digits_ = ntt::multiply(transforms(length, whole ? my_limbs : chunk),
+                                       ntt::Transformed(other.digits_, length,
+                                                        whole ? chunk : their_limbs));
+        result.trim();
+        return result;
+    }
+    if (static_cast<int>(shorter) < TuningProfile::active().schoolbook_limbs) {
+        return BigInt::accumulateProducts(BigInt(), &value_, &other, 1, 1);
+    }
+
+    const std::vector<int> other_digits =
+        BigInt::convertBase(other.digits_, BigInt::kBaseDigits, 6);
+    std::size_t size = 1;
+    while (size < std::min(digits_.size(), other_digits.size())) {
+        size *= 2;
+    }
+    const std::vector<Evaluation>& mine = blocks(size);
+    const std::vector<Evaluation> theirs = evaluateBlocks(other_digits, size, leaf_);
+
+    std::vector<uint64_t> product((mine.size() + theirs.size()) * size);
+    std::vector<uint64_t> scratch(6 * size);
+    for (std::size_t i = 0; i < mine.size(); ++i) {
+        for (std::size_t j = 0; j < theirs.size(); ++j) {
+            multiplyEvaluated(mine[i].data(), theirs[j].data(), size, leaf_,
+                              product.data() + (i + j) * size, scratch.data());
+        }
+    }
+
+    std::vector<int> digits6;
+    digits6.reserve(product.size() + 1);
+    uint64_t carry = 0;
+    for (uint64_t coefficient : product) {
+        const uint64_t cur = coefficient + carry;
+        digits6.push_back(static_cast<int>(cur % 1000000));
+        carry = cur / 1000000;
+    }
+    BigInt result;
+    result.sign_ = value_.sign_ * other.sign_;
+    result.digits_ = BigInt::convertBase(digits6, 6, BigInt::kBaseDigits);
+    result.trim();
+    return result;
+}
+
+BigInt operator*(const BigInt& lhs, const PreparedMultiplier& rhs) {
+    return rhs.multiply(lhs);
+}
+
+BigInt operator*(const PreparedMultiplier& lhs, const BigInt& rhs) {
+    return lhs.multiply(rhs);
+}
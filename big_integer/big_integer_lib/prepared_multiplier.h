@@ -0,0 +1,55 @@
+#pragma once
+
+#include "big_int.h"
+#include "ntt.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/*
+    A BigInt prepared as the fixed factor of many multiplications. Karatsuba multiplication
+    evaluates both operands recursively at 0, 1 and infinity (low half, sum of halves, high
+    half), multiplies the leaves pointwise and interpolates; the evaluation of one operand does
+    not depend on the other. The prepared operand keeps its base-10^6 digits and, for every
+    block size used so far, the evaluated leaves of its blocks, so a product only converts and
+    evaluates the other operand. The evaluations take (3/2)^k times the space of the digits,
+    where k is the number of Karatsuba levels.
+
+    The longer operand is cut into blocks of the shorter one's padded length, so unbalanced
+    products cost a balanced product per block. Where operator* would use number-theoretic
+    transforms, the prepared operand keeps its transforms instead, for every transform length
+    and chunk size used so far, and a product only transforms the other operand and the
+    pointwise product back; they take 12 bytes per transform value, about 3 to 6 times the
+    space of the limbs. Below the schoolbook threshold of the tuning profile there is nothing to
+    reuse and the base-10^9 limbs are multiplied directly.
+*/
+class PreparedMultiplier {
+public:
+    explicit PreparedMultiplier(const BigInt& value);
+
+    const BigInt& value() const;
+
+    // value() * other; may be called from several threads at once.
+    BigInt multiply(const BigInt& other) const;
+
+private:
+    using Evaluation = std::vector<uint64_t>;
+
+    BigInt value_;
+    std::vector<int> digits_;  // base-10^6, least significant first
+    std::size_t leaf_;         // Karatsuba base case the evaluations were made with
+
+    mutable std::mutex mutex_;
+    mutable std::map<std::size_t, std::vector<Evaluation>> blocks_;  // by block size
+    // by transform length and chunk size
+    mutable std::map<std::pair<std::size_t, std::size_t>, ntt::Transformed> transforms_;
+
+    const std::vector<Evaluation>& blocks(std::size_t size) const;
+    const ntt::Transformed& transforms(std::size_t length, std::size_t chunk) const;
+};
+
+BigInt operator*(const BigInt&, const PreparedMultiplier&);
+BigInt operator*(const PreparedMultiplier&, const BigInt&);
@@ -0,0 +1,350 @@
+#include "primality.h"
+#include "divisor.h"
+#include "natural.h"
+#include "number_theory.h"
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+
+namespace {
+
+using natural::Limbs;
+using natural::Montgomery;
+
+/*
+    Shared sieve table
+*/
+
+// The primes below kSieveLimit, grouped so that the product of every group fits into a
+// Divisor: one remainder pass over the limbs serves the whole group.
+struct SmallPrimes {
+    struct Group {
+        Divisor divisor;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    std::vector<uint32_t> primes;
+    std::vector<Group> groups;
+
+    SmallPrimes() {
+        std::vector<bool> composite(kSieveLimit);
+        for (uint32_t p = 2; p < kSieveLimit; ++p) {
+            if (!composite[p]) {
+                primes.push_back(p);
+                for (uint32_t multiple = p * p; multiple < kSieveLimit; multiple += p) {
+                    composite[multiple] = true;
+                }
+            }
+        }
+        for (std::size_t begin = 0; begin < primes.size();) {
+            int64_t group_product = 1;
+            std::size_t end = begin;
+            while (end < primes.size() && group_product < (int64_t(1) << 62) / primes[end]) {
+                group_product *= primes[end++];
+            }
+            groups.push_back({Divisor(group_product), begin, end});
+            begin = end;
+        }
+    }
+};
+
+const SmallPrimes& smallPrimes() {
+    static const SmallPrimes table;
+    return table;
+}
+
+// n mod p for every small prime p, for n >= 0.
+std::vector<uint32_t> smallResidues(const BigInt& n) {
+    const SmallPrimes& table = smallPrimes();
+    std::vector<uint32_t> residues(table.primes.size());
+    for (const SmallPrimes::Group& group : table.groups) {
+        const int64_t r = group.divisor.remainder(n);
+        for (std::size_t i = group.begin; i < group.end; ++i) {
+            residues[i] = static_cast<uint32_t>(r % table.primes[i]);
+        }
+    }
+    return residues;
+}
+
+enum class Verdict { kComposite, kPrime, kUnknown };
+
+// Trial division of n >= 2 by the small primes.
+Verdict trialDivide(const BigInt& n) {
+    const SmallPrimes& table = smallPrimes();
+    for (const SmallPrimes::Group& group : table.groups) {
+        const int64_t r = group.divisor.remainder(n);
+        for (std::size_t i = group.begin; i < group.end; ++i) {
+            if (r % table.primes[i] == 0) {
+                return n == table.primes[i] ? Verdict::kPrime : Verdict::kComposite;
+            }
+        }
+    }
+    return n < int64_t(kSieveLimit) * kSieveLimit ? Verdict::kPrime : Verdict::kUnknown;
+}
+
+/*
+    Strong tests
+*/
+
+// x / 2 mod m for an odd modulus m.
+void halve(Limbs* x, const Limbs& m) {
+    uint32_t carry = 0;
+    if ((*x)[0] & 1) {
+        uint64_t sum = 0;
+        for (std::size_t i = 0; i < x->size(); ++i) {
+            sum += static_cast<uint64_t>((*x)[i]) + m[i];
+            (*x)[i] = static_cast<uint32_t>(sum);
+            sum >>= 32;
+        }
+        carry = static_cast<uint32_t>(sum);
+    }
+    for (std::size_t i = 0; i + 1 < x->size(); ++i) {
+        (*x)[i] = ((*x)[i] >> 1) | ((*x)[i + 1] << 31);
+    }
+    x->back() = (x->back() >> 1) | (carry << 31);
+}
+
+// Montgomery form of a small signed value, |value| < m.
+Limbs smallResidue(const Montgomery& montgomery, int64_t value) {
+    const Limbs magnitude = natural::fromUint64(value < 0 ? -value : value);
+    Limbs result = montgomery.toMontgomery(magnitude);
+    if (value < 0) {
+        const Limbs zero(montgomery.size());
+        montgomery.sub(zero.data(), result.data(), result.data());
+    }
+    return result;
+}
+
+// Strong probable prime test to base 2 for an odd modulus.
+bool strongFermat(const Montgomery& montgomery) {
+    const Limbs& m = montgomery.modulus();
+    Limbs d = natural::sub(m, {1});
+    std::size_t s = 0;
+    while (!((d[s / 32] >> (s % 32)) & 1)) {
+        ++s;
+    }
+    d = natural::shiftRight(d, s);
+
+    const Limbs one = montgomery.one();
+    const Limbs minus_one = smallResidue(montgomery, -1);
+    Limbs x = montgomery.pow(montgomery.toMontgomery({2}), d);
+    if (x == one || x == minus_one) {
+        return true;
+    }
+    for (std::size_t i = 1; i < s; ++i) {
+        montgomery.multiply(x.data(), x.data(), x.data());
+        if (x == minus_one) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Jacobi symbol (a / n) for odd n > 0.
+int jacobi(int64_t a, int64_t n) {
+    a %= n;
+    if (a < 0) {
+        a += n;
+    }
+    int result = 1;
+    while (a) {
+        while (!(a & 1)) {
+            a >>= 1;
+            if (n % 8 == 3 || n % 8 == 5) {
+                result = -result;
+            }
+        }
+        std::swap(a, n);
+        if (a % 4 == 3 && n % 4 == 3) {
+            result = -result;
+        }
+        a %= n;
+    }
+    return n == 1 ? result : 0;
+}
+
+// Jacobi symbol (d / n) for a small odd d and a big odd n > 0, by reciprocity.
+int jacobi(int64_t d, const BigInt& n) {
+    const int n_mod_4 = BigIntAccess::digits(n)[0] % 4;
+    int result = 1;
+    if (d < 0) {
+        d = -d;
+        if (n_mod_4 == 3) {
+            result = -result;
+        }
+    }
+    if (d % 4 == 3 && n_mod_4 == 3) {
+        result = -result;
+    }
+    return result * jacobi(Divisor(d).remainder(n), d);
+}
+
+// Strong Lucas probable prime test with P = 1 and Selfridge's choice of D and Q.
+bool strongLucas(const BigInt& n, const Montgomery& montgomery) {
+    int64_t d = 5;
+    for (int attempt = 0;; ++attempt) {
+        const int symbol = jacobi(d, n);
+        if (symbol == -1) {
+            break;
+        }
+        if (symbol == 0) {
+            return false;  // |d| < n shares a factor with n
+        }
+        if (attempt == 5 && is_perfect_square(n)) {
+            return false;  // no suitable d exists for squares
+        }
+        d = d > 0 ? -(d + 2) : -d + 2;
+    }
+    const int64_t q = (1 - d) / 4;
+
+    // n + 1 = k * 2^s with k odd.
+    const Limbs& m = montgomery.modulus();
+    Limbs k = natural::add(m, {1});
+    std::size_t s = 0;
+    while (!((k[s / 32] >> (s % 32)) & 1)) {
+        ++s;
+    }
+    k = natural::shiftRight(k, s);
+
+    const Limbs d_residue = smallResidue(montgomery, d);
+    const Limbs q_residue = smallResidue(montgomery, q);
+    Limbs u = montgomery.one();
+    Limbs v = u;
+    Limbs q_power = q_residue;
+    Limbs temp(montgomery.size());
+
+    // U_2j = U_j V_j, V_2j = V_j^2 - 2 Q^j, and from 2j to 2j + 1:
+    // U' = (U + V) / 2, V' = (D U + V) / 2.
+    for (std::size_t bit = natural::bitLength(k) - 1; bit-- > 0;) {
+        montgomery.multiply(u.data(), v.data(), u.data());
+        montgomery.multiply(v.data(), v.data(), v.data());
+        montgomery.add(q_power.data(), q_power.data(), temp.data());
+        montgomery.sub(v.data(), temp.data(), v.data());
+        montgomery.multiply(q_power.data(), q_power.data(), q_power.data());
+        if ((k[bit / 32] >> (bit % 32)) & 1) {
+            montgomery.multiply(d_residue.data(), u.data(), temp.data());
+            montgomery.add(u.data(), v.data(), u.data());
+            halve(&u, m);
+            montgomery.add(temp.data(), v.data(), v.data());
+            halve(&v, m);
+            montgomery.multiply(q_power.data(), q_residue.data(), q_power.data());
+        }
+    }
+    if (natural::isZero(u) || natural::isZero(v)) {
+        return true;
+    }
+    for (std::size_t r = 1; r < s; ++r) {
+        montgomery.multiply(v.data(), v.data(), v.data());
+        montgomery.add(q_power.data(), q_power.data(), temp.data());
+        montgomery.sub(v.data(), temp.data(), v.data());
+        if (natural::isZero(v)) {
+            return true;
+        }
+        montgomery.multiply(q_power.data(), q_power.data(), q_power.data());
+    }
+    return false;
+}
+
+// Baillie-PSW for an odd n without small factors.
+bool strongTests(const BigInt& n) {
+    const Montgomery montgomery(BigIntAccess::magnitude(n));
+    return strongFermat(montgomery) && strongLucas(n, montgomery);
+}
+
+}  // namespace
+
+/*
+    Public interface
+*/
+
+bool is_probable_prime(const BigInt& n) {
+    if (n < 2) {
+        return false;
+    }
+    switch (trialDivide(n)) {
+        case Verdict::kComposite:
+            return false;
+        case Verdict::kPrime:
+            return true;
+        default:
+            return strongTests(n);
+    }
+}
+
+BigInt next_prime(const BigInt& n) {
+    BigInt candidate = n < 2 ? BigInt(2) : n + 1;
+    while (candidate < int64_t(kSieveLimit) * kSieveLimit) {
+        if (is_probable_prime(candidate)) {
+            return candidate;
+        }
+        ++candidate;
+    }
+    if (BigIntAccess::digits(candidate)[0] % 2 == 0) {
+        ++candidate;
+    }
+
+    // Window of kWindow odd candidates; candidate + 2 j is divisible by p when
+    // j = -residue / 2 (mod p). The candidates exceed every sieving prime.
+    const uint32_t kWindow = 4096;
+    const std::vector<uint32_t>& primes = smallPrimes().primes;
+    std::vector<uint32_t> residues = smallResidues(candidate);
+    std::vector<bool> composite(kWindow);
+    for (;;) {
+        std::fill(composite.begin(), composite.end(), false);
+        for (std::size_t i = 1; i < primes.size(); ++i) {
+            const uint32_t p = primes[i];
+            const uint32_t first = (p - residues[i]) % p * ((p + 1) / 2) % p;
+            for (uint32_t j = first; j < kWindow; j += p) {
+                composite[j] = true;
+            }
+        }
+        for (uint32_t j = 0; j < kWindow; ++j) {
+            if (!composite[j]) {
+                BigInt value = candidate + int64_t(2) * j;
+                if (strongTests(value)) {
+                    return value;
+                }
+            }
+        }
+        candidate += int64_t(2) * kWindow;
+        for (std::size_t i = 0; i < primes.size(); ++i) {
+            residues[i] = (residues[i] + 2 * kWindow) % primes[i];
+        }
+    }
+}
+
+std::vector<bool> are_probable_primes(const std::vector<BigInt>& candidates) {
+    std::vector<char> result(candidates.size());
+    std::vector<std::size_t> pending;
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (candidates[i] < 2) {
+            continue;
+        }
+        const Verdict verdict = trialDivide(candidates[i]);
+        if (verdict == Verdict::kUnknown) {
+            pending.push_back(i);
+        } else {
+            result[i] = verdict == Verdict::kPrime;
+        }
+    }
+
+    std::atomic<std::size_t> next{0};
+    auto worker = [&]() {
+        for (std::size_t k; (k = next++) < pending.size();) {
+            result[pending[k]] = strongTests(candidates[pending[k]]);
+        }
+    };
+    const std::size_t threads =
+        std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), pending.size());
+    std::vector<std::future<void>> workers;
+    for (std::size_t t = 1; t < threads; ++t) {
+        workers.push_back(std::async(std::launch::async, worker));
+    }
+    worker();
+    for (std::future<void>& future : workers) {
+        future.get();
+    }
+    return std::vector<bool>(result.begin(), result.end());
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "big_int.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+    Probabilistic primality testing. Candidates are first trial-divided by the primes below
+    kSieveLimit, using a table of prime-product Divisors shared by all callers, so most
+    composites are rejected by a few linear passes over the limbs. Survivors get the
+    Baillie-PSW test: a strong Fermat test to base 2 and a strong Lucas test with Selfridge's
+    parameters, both in Montgomery arithmetic modulo the candidate. No BPSW pseudoprime is
+    known; below kSieveLimit^2 the answer is exact.
+*/
+
+const uint32_t kSieveLimit = 4096;
+
+bool is_probable_prime(const BigInt& n);  // NOLINT
+
+// The smallest probable prime greater than n. Candidates are sieved in windows: the residues
+// of the window start modulo every small prime are computed once and shifted along.
+BigInt next_prime(const BigInt& n);  // NOLINT
+
+// is_probable_prime for every candidate. The sieve runs first; the strong tests of the
+// survivors are spread across hardware threads, each with its own Montgomery contexts.
+std::vector<bool> are_probable_primes(const std::vector<BigInt>& candidates);  // NOLINT
@@ -0,0 +1,259 @@
+#include "rns.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+const uint32_t kLargestPrime = 2147483647;  // 2^31 - 1; every basis prime is above 2^30
+
+// a * b mod p for a, b < p with 2^30 < p < 2^31. The quotient estimate
+// ((x >> 30) * floor(2^62 / p)) >> 32 of x = a * b is at most 2 below the true quotient.
+uint32_t mulMod(uint32_t a, uint32_t b, uint32_t p, uint64_t reciprocal) {
+    const uint64_t x = static_cast<uint64_t>(a) * b;
+    uint64_t r = x - ((x >> 30) * reciprocal >> 32) * p;
+    r -= r >= p ? p : 0;
+    r -= r >= p ? p : 0;
+    return static_cast<uint32_t>(r);
+}
+
+uint32_t powMod(uint32_t base, uint32_t exponent, uint32_t p) {
+    uint64_t result = 1;
+    uint64_t power = base % p;
+    for (; exponent; exponent >>= 1) {
+        if (exponent & 1) {
+            result = result * power % p;
+        }
+        power = power * power % p;
+    }
+    return static_cast<uint32_t>(result);
+}
+
+// Deterministic Miller-Rabin for odd n < 2^32: bases 2, 7 and 61 suffice.
+bool isPrime(uint32_t n) {
+    uint32_t d = n - 1;
+    int s = 0;
+    while (!(d & 1)) {
+        d >>= 1;
+        ++s;
+    }
+    for (uint32_t base : {2u, 7u, 61u}) {
+        uint64_t x = powMod(base, d, n);
+        if (x == 1 || x == n - 1) {
+            continue;
+        }
+        bool composite = true;
+        for (int i = 1; i < s && composite; ++i) {
+            x = x * x % n;
+            composite = x != n - 1;
+        }
+        if (composite) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+/*
+    RnsBasis
+*/
+
+RnsBasis::RnsBasis(std::size_t max_digits) : max_digits_(max_digits) {
+    // M >= 2^(30 k) must exceed 2 * 10^max_digits.
+    const double bits = static_cast<double>(max_digits) * std::log2(10.0) + 2;
+    const std::size_t count = std::max<std::size_t>(1, static_cast<std::size_t>(bits / 30) + 1);
+    for (uint32_t candidate = kLargestPrime; primes_.size() < count; candidate -= 2) {
+        if (isPrime(candidate)) {
+            primes_.push_back(candidate);
+            reciprocals_.push_back((uint64_t(1) << 62) / candidate);
+        }
+    }
+
+    // Quadratic in the number of primes; a basis is meant to be built once and shared.
+    weights_.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        uint32_t cofactor = 1;
+        for (std::size_t j = 0; j < count; ++j) {
+            if (j != i) {
+                cofactor = mulMod(cofactor, primes_[j] % primes_[i], primes_[i], reciprocals_[i]);
+            }
+        }
+        weights_[i] = powMod(cofactor, primes_[i] - 2, primes_[i]);
+    }
+
+    for (std::size_t i = 0; i < count; i += 2) {
+        pairs_.emplace_back(i + 1 < count ? int64_t(primes_[i]) * primes_[i + 1] : primes_[i]);
+    }
+    tree_.resize(4 * count);
+    buildTree(0, 0, count);
+    half_ = tree_[0] / 2;
+}
+
+void RnsBasis::buildTree(std::size_t node, std::size_t begin, std::size_t end) {
+    if (end - begin == 1) {
+        tree_[node] = BigInt(primes_[begin]);
+        return;
+    }
+    const std::size_t middle = (begin + end) / 2;
+    buildTree(2 * node + 1, begin, middle);
+    buildTree(2 * node + 2, middle, end);
+    tree_[node] = tree_[2 * node + 1] * tree_[2 * node + 2];
+}
+
+std::size_t RnsBasis::maxDigits() const {
+    return max_digits_;
+}
+
+std::size_t RnsBasis::size() const {
+    return primes_.size();
+}
+
+const std::vector<uint32_t>& RnsBasis::primes() const {
+    return primes_;
+}
+
+const BigInt& RnsBasis::product() const {
+    return tree_[0];
+}
+
+std::vector<uint32_t> RnsBasis::toResidues(const BigInt& x) const {
+    if (x.abs() > half_) {
+        throw std::out_of_range("RnsBasis: value out of the range of the basis");
+    }
+    std::vector<uint32_t> residues(primes_.size());
+    for (std::size_t k = 0; k < pairs_.size(); ++k) {
+        int64_t r = pairs_[k].remainder(x);
+        if (r < 0) {
+            r += pairs_[k].value();
+        }
+        for (std::size_t i = 2 * k; i < 2 * k + 2 && i < primes_.size(); ++i) {
+            residues[i] = static_cast<uint32_t>(r % primes_[i]);
+        }
+    }
+    return residues;
+}
+
+BigInt RnsBasis::fromResidues(const std::vector<uint32_t>& residues) const {
+    if (residues.size() != primes_.size()) {
+        throw std::invalid_argument("RnsBasis: wrong number of residues");
+    }
+    std::vector<uint32_t> terms(residues.size());
+    mul(residues.data(), weights_.data(), terms.data());
+    // The combined sum S is the sum of terms[i] * M / p_i, so S / M is the sum of the fractions
+    // terms[i] / p_i; subtracting the nearest multiple of M leaves the centred residue, up to
+    // one correction for rounding errors.
+    double quotient = 0;
+    for (std::size_t i = 0; i < terms.size(); ++i) {
+        quotient += static_cast<double>(terms[i]) / primes_[i];
+    }
+    BigInt x = combine(terms, 0, 0, primes_.size()) - tree_[0] * std::llround(quotient);
+    if (x > half_) {
+        x -= tree_[0];
+    } else if (x < -half_) {
+        x += tree_[0];
+    }
+    return x;
+}
+
+BigInt RnsBasis::combine(const std::vector<uint32_t>& terms, std::size_t node, std::size_t begin,
+                         std::size_t end) const {
+    if (end - begin == 1) {
+        return BigInt(terms[begin]);
+    }
+    const std::size_t middle = (begin + end) / 2;
+    return combine(terms, 2 * node + 1, begin, middle) * tree_[2 * node + 2] +
+           combine(terms, 2 * node + 2, middle, end) * tree_[2 * node + 1];
+}
+
+void RnsBasis::add(const uint32_t* a, const uint32_t* b, uint32_t* out) const {
+    for (std::size_t i = 0; i < primes_.size(); ++i) {
+        const uint32_t sum = a[i] + b[i];
+        out[i] = sum >= primes_[i] ? sum - primes_[i] : sum;
+    }
+}
+
+void RnsBasis::sub(const uint32_t* a, const uint32_t* b, uint32_t* out) const {
+    for (std::size_t i = 0; i < primes_.size(); ++i) {
+        const uint32_t difference = a[i] - b[i] + primes_[i];
+        out[i] = difference >= primes_[i] ? difference - primes_[i] : difference;
+    }
+}
+
+void RnsBasis::mul(const uint32_t* a, const uint32_t* b, uint32_t* out) const {
+    for (std::size_t i = 0; i < primes_.size(); ++i) {
+        out[i] = mulMod(a[i], b[i], primes_[i], reciprocals_[i]);
+    }
+}
+
+/*
+    RnsInteger
+*/
+
+RnsInteger::RnsInteger(std::shared_ptr<const RnsBasis> basis, const BigInt& value)
+    : basis_(std::move(basis)) {
+    if (!basis_) {
+        throw std::invalid_argument("RnsInteger: null basis");
+    }
+    residues_ = basis_->toResidues(value);
+}
+
+const std::shared_ptr<const RnsBasis>& RnsInteger::basis() const {
+    return basis_;
+}
+
+const std::vector<uint32_t>& RnsInteger::residues() const {
+    return residues_;
+}
+
+BigInt RnsInteger::toBigInt() const {
+    return basis_->fromResidues(residues_);
+}
+
+void RnsInteger::checkBasis(const RnsInteger& other) const {
+    if (basis_ != other.basis_) {
+        throw std::invalid_argument("RnsInteger: operands use different bases");
+    }
+}
+
+RnsInteger& RnsInteger::operator+=(const RnsInteger& other) {
+    checkBasis(other);
+    basis_->add(residues_.data(), other.residues_.data(), residues_.data());
+    return *this;
+}
+
+RnsInteger& RnsInteger::operator-=(const RnsInteger& other) {
+    checkBasis(other);
+    basis_->sub(residues_.data(), other.residues_.data(), residues_.data());
+    return *this;
+}
+
+RnsInteger& RnsInteger::operator*=(const RnsInteger& other) {
+    checkBasis(other);
+    basis_->mul(residues_.data(), other.residues_.data(), residues_.data());
+    return *this;
+}
+
+RnsInteger RnsInteger::operator+(const RnsInteger& other) const {
+    RnsInteger result = *this;
+    return result += other;
+}
+
+RnsInteger RnsInteger::operator-(const RnsInteger& other) const {
+    RnsInteger result = *this;
+    return result -= other;
+}
+
+RnsInteger RnsInteger::operator*(const RnsInteger& other) const {
+    RnsInteger result = *this;
+    return result *= other;
+}
+
+RnsInteger RnsInteger::operator-() const {
+    RnsInteger result = *this;
+    const std::vector<uint32_t> zero(residues_.size());
+    basis_->sub(zero.data(), residues_.data(), result.residues_.data());
+    return result;
+}
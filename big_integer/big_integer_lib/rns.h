@@ -0,0 +1,84 @@
+#pragma once
+
+#include "big_int.h"
+#include "divisor.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+    Residue number system. A value is held as its residues modulo a basis of primes between
+    2^30 and 2^31, so +, - and * work on every residue independently with 64-bit arithmetic and
+    no carries between them: long chains of operations cost one linear pass per operation and
+    the conversion back to a BigInt is paid once at the end.
+
+    The basis is chosen from the largest result the computation may produce. Its product M
+    exceeds 2 * 10^max_digits, and every value (intermediate ones included) must satisfy
+    |x| < 10^max_digits; a value outside that range silently comes back reduced modulo M.
+*/
+class RnsBasis {
+public:
+    explicit RnsBasis(std::size_t max_digits);
+
+    std::size_t maxDigits() const;
+    std::size_t size() const;
+    const std::vector<uint32_t>& primes() const;
+    const BigInt& product() const;
+
+    // Residues of x modulo every prime; pairs of primes share one Divisor pass over the limbs.
+    // Throws std::out_of_range if |x| > M / 2.
+    std::vector<uint32_t> toResidues(const BigInt& x) const;
+
+    // The value in [-M / 2, M / 2] with the given residues, by the Chinese remainder theorem:
+    // the terms residue * (M / p)^-1 mod p are combined up the subproduct tree of the primes,
+    // x(L + R) = x(L) * M(R) + x(R) * M(L), and the multiple of M to subtract is the rounded
+    // sum of term / p in floating point, so no long division is needed.
+    BigInt fromResidues(const std::vector<uint32_t>& residues) const;
+
+    // out[i] = a[i] op b[i] modulo primes()[i]. The loops are branch-free and independent per
+    // residue; out may alias a or b.
+    void add(const uint32_t* a, const uint32_t* b, uint32_t* out) const;
+    void sub(const uint32_t* a, const uint32_t* b, uint32_t* out) const;
+    void mul(const uint32_t* a, const uint32_t* b, uint32_t* out) const;
+
+private:
+    std::size_t max_digits_;
+    std::vector<uint32_t> primes_;
+    std::vector<uint64_t> reciprocals_;  // floor(2^62 / p), for Barrett reduction
+    std::vector<uint32_t> weights_;      // (M / p)^-1 mod p
+    std::vector<Divisor> pairs_;         // products of consecutive primes, below 2^62
+    std::vector<BigInt> tree_;           // subproducts, tree_[0] = M, children 2 i + 1, 2 i + 2
+    BigInt half_;                        // floor(M / 2)
+
+    void buildTree(std::size_t node, std::size_t begin, std::size_t end);
+    BigInt combine(const std::vector<uint32_t>& terms, std::size_t node, std::size_t begin,
+                   std::size_t end) const;
+};
+
+/*
+    An integer in residue form over a shared basis. Operands of one operation must use the same
+    basis object; the basis is kept alive by every value that uses it.
+*/
+class RnsInteger {
+public:
+    RnsInteger(std::shared_ptr<const RnsBasis> basis, const BigInt& value);
+
+    const std::shared_ptr<const RnsBasis>& basis() const;
+    const std::vector<uint32_t>& residues() const;
+    BigInt toBigInt() const;
+
+    RnsInteger& operator+=(const RnsInteger&);
+    RnsInteger& operator-=(const RnsInteger&);
+    RnsInteger& operator*=(const RnsInteger&);
+    RnsInteger operator+(const RnsInteger&) const;
+    RnsInteger operator-(const RnsInteger&) const;
+    RnsInteger operator*(const RnsInteger&) const;
+    RnsInteger operator-() const;
+
+private:
+    std::shared_ptr<const RnsBasis> basis_;
+    std::vector<uint32_t> residues_;
+
+    void checkBasis(const RnsInteger&) const;
+};
@@ -0,0 +1,337 @@
+#include "service.h"
+#include "calculator.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const int kPollMilliseconds = 100;  // how often blocked reads and accepts look at the token
+
+bool cancelled(const EvaluationBudget& budget) {
+    return budget.cancellation != nullptr && budget.cancellation->cancelled();
+}
+
+bool isBlank(const std::string& line) {
+    return line.find_first_not_of(" \t\r") == std::string::npos;
+}
+
+std::future<std::string> readyFuture(std::string response) {
+    std::promise<std::string> promise;
+    promise.set_value(std::move(response));
+    return promise.get_future();
+}
+
+// The response to an expression request. Variables are read under the session's lock; the
+// arithmetic itself runs unlocked.
+std::string answer(const std::string& request, FormulaEngine* engine, std::mutex* engine_mutex,
+                   const EvaluationBudget& budget) {
+    thread_local std::vector<std::string> rpn;  // worker scratch, reused across requests
+    try {
+        std::queue<std::string> tokens = getExpressionTokens(request);
+        rpn.clear();
+        if (!infixToRPN(&tokens, tokens.size(), &rpn)) {
+            return "Error: Mis-match in parentheses";
+        }
+        const BigInt result = evaluateRPN(
+            rpn,
+            [engine, engine_mutex](const std::string& name) {
+                const std::lock_guard<std::mutex> lock(*engine_mutex);
+                return engine->value(name);
+            },
+            budget);
+        return BigInt::to_string(result);
+    } catch (const std::exception& error) {
+        return std::string("Error: ") + error.what();
+    }
+}
+
+// Newline-delimited reads from a file descriptor that give up once the token fires.
+class LineReader {
+public:
+    LineReader(int fd, const EvaluationBudget& budget) : fd_(fd), budget_(budget) {
+    }
+
+    bool read(std::string* line) {
+        for (;;) {
+            const std::size_t newline = buffer_.find('\n', begin_);
+            if (newline != std::string::npos) {
+                line->assign(buffer_, begin_, newline - begin_);
+                begin_ = newline + 1;
+                return true;
+            }
+            buffer_.erase(0, begin_);
+            begin_ = 0;
+            if (cancelled(budget_)) {
+                return false;
+            }
+            pollfd request = {fd_, POLLIN, 0};
+            const int ready = ::poll(&request, 1, kPollMilliseconds);
+            if (ready == 0 || (ready < 0 && errno == EINTR)) {
+                continue;
+            }
+            char chunk[4096];
+            const ssize_t size = ready < 0 ? -1 : ::read(fd_, chunk, sizeof(chunk));
+            if (size < 0 && errno == EINTR) {
+                continue;
+            }
+            if (size <= 0) {
+                // End of input: a final line without a newline still counts.
+                line->swap(buffer_);
+                buffer_.clear();
+                return !line->empty();
+            }
+            buffer_.append(chunk, size);
+        }
+    }
+
+private:
+    int fd_;
+    const EvaluationBudget& budget_;
+    std::string buffer_;
+    std::size_t begin_ = 0;  // start of the unread part of buffer_
+};
+
+bool writeAll(int fd, const std::string& data) {
+    for (std::size_t written = 0; written < data.size();) {
+        ssize_t size = ::send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        if (size < 0 && errno == ENOTSOCK) {
+            size = ::write(fd, data.data() + written, data.size() - written);
+        }
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size <= 0) {
+            return false;
+        }
+        written += size;
+    }
+    return true;
+}
+
+}  // namespace
+
+CalculatorService::CalculatorService(const ServiceOptions& options) : options_(options) {
+    options_.max_in_flight = std::max<std::size_t>(1, options_.max_in_flight);
+    const std::size_t workers =
+        options_.workers ? options_.workers : std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t i = 0; i < workers; ++i) {
+        workers_.emplace_back(&CalculatorService::work, this);
+    }
+}
+
+CalculatorService::~CalculatorService() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    task_ready_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+std::size_t CalculatorService::handled() const {
+    return handled_.load();
+}
+
+/*
+    Worker pool
+*/
+
+std::future<std::string> CalculatorService::submit(std::function<std::string()> task) {
+    auto packaged = std::make_shared<std::packaged_task<std::string()>>(std::move(task));
+    std::future<std::string> result = packaged->get_future();
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.emplace_back([packaged]() { (*packaged)(); });
+    }
+    task_ready_.notify_one();
+    return result;
+}
+
+void CalculatorService::work() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            task_ready_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+/*
+    Sessions
+*/
+
+void CalculatorService::serve(const std::function<bool(std::string*)>& read_line,
+                              const std::function<bool(const std::string&)>& write_line) {
+    FormulaEngine engine;
+    engine.setBudget(options_.budget);
+    std::mutex engine_mutex;
+
+    // Responses in request order. Only this thread appends and only the writer removes, and
+    // deque references survive both, so the writer waits on the front without the lock.
+    std::deque<std::future<std::string>> pending;
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool reading_done = false;
+    bool broken = false;
+
+    std::thread writer([&]() {
+        for (;;) {
+            std::future<std::string>* front;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() { return reading_done || !pending.empty(); });
+                if (pending.empty()) {
+                    return;
+                }
+                front = &pending.front();
+            }
+            const std::string response = front->get();  // always awaited: tasks use the engine
+            const bool written = !broken && write_line(response);
+            {
+                const std::lock_guard<std::mutex> lock(mutex);
+                broken = broken || !written;
+                pending.pop_front();
+            }
+            ++handled_;
+            changed.notify_all();
+        }
+    });
+
+    std::string line;
+    while (read_line(&line)) {
+        if (isBlank(line)) {
+            continue;
+        }
+        std::string name, expression;
+        const bool assignment = FormulaEngine::parseAssignment(line, &name, &expression);
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&]() {
+            const std::size_t limit = assignment ? 1 : options_.max_in_flight;
+            return broken || pending.size() < limit;
+        });
+        if (broken) {
+            break;
+        }
+        if (assignment) {
+            // Nothing is in flight, so the engine can be changed without its lock.
+            try {
+                engine.assign(name, expression);
+                pending.push_back(readyFuture("Defined " + name));
+            } catch (const std::exception& error) {
+                pending.push_back(readyFuture(std::string("Error: ") + error.what()));
+            }
+        } else {
+            pending.push_back(submit([this, line, &engine, &engine_mutex]() {
+                return answer(line, &engine, &engine_mutex, options_.budget);
+            }));
+        }
+        lock.unlock();
+        changed.notify_all();
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        reading_done = true;
+    }
+    changed.notify_all();
+    writer.join();
+}
+
+void CalculatorService::serve(std::istream& in, std::ostream& out) {
+    serve([&in](std::string* line) { return static_cast<bool>(std::getline(in, *line)); },
+          [&out](const std::string& response) {
+              out << response << '\n';
+              out.flush();
+              return static_cast<bool>(out);
+          });
+}
+
+void CalculatorService::serve(int in_fd, int out_fd) {
+    LineReader reader(in_fd, options_.budget);
+    serve([&reader](std::string* line) { return reader.read(line); },
+          [out_fd](const std::string& response) { return writeAll(out_fd, response + '\n'); });
+}
+
+void CalculatorService::listen(const std::string& path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + path);
+    }
+    std::copy(path.begin(), path.end(), address.sun_path);
+
+    const int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) {
+        throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+    }
+    // Only a socket left behind by an earlier server is replaced.
+    struct stat existing;
+    if (::lstat(path.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            ::close(server);
+            throw std::runtime_error("Cannot listen on " + path + ": not a socket");
+        }
+        ::unlink(path.c_str());
+    }
+    if (::bind(server, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(server, SOMAXCONN) < 0) {
+        const std::string message = std::strerror(errno);
+        ::close(server);
+        throw std::runtime_error("Cannot listen on " + path + ": " + message);
+    }
+
+    struct Connection {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+    std::vector<Connection> connections;
+    while (!cancelled(options_.budget)) {
+        pollfd request = {server, POLLIN, 0};
+        if (::poll(&request, 1, kPollMilliseconds) > 0) {
+            const int client = ::accept(server, nullptr, nullptr);
+            if (client >= 0) {
+                auto done = std::make_shared<std::atomic<bool>>(false);
+                connections.push_back({std::thread([this, client, done]() {
+                                           serve(client, client);
+                                           ::close(client);
+                                           *done = true;
+                                       }),
+                                       done});
+            }
+        }
+        // Reap finished sessions.
+        for (auto it = connections.begin(); it != connections.end();) {
+            if (*it->done) {
+                it->thread.join();
+                it = connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    ::close(server);
+    ::unlink(path.c_str());
+    for (Connection& connection : connections) {
+        connection.thread.join();
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "budget.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+    Long-running calculator service. Requests are newline-delimited lines in the calculator
+    syntax, read from a stream, a pair of file descriptors or the connections of a Unix-domain
+    socket. Each non-blank line gets exactly one response line, in request order: the value of
+    an expression, "Defined <name>" for an assignment, or "Error: <message>".
+
+    Expressions are evaluated by a pool of worker threads that lives as long as the service, so
+    several requests of a session are in flight at once while a writer returns the answers in
+    order. The workers keep their scratch buffers and the library's process-wide tables (sieve
+    primes, the tuning profile) warm across requests and sessions.
+
+    Every session has its own variables. An assignment waits until the requests before it have
+    been answered, so each expression sees exactly the assignments that precede it.
+*/
+
+struct ServiceOptions {
+    std::size_t workers = 0;         // 0: one per hardware thread
+    std::size_t max_in_flight = 64;  // unanswered requests a session may have
+    EvaluationBudget budget;         // applied to every request; its token also stops serving
+};
+
+class CalculatorService {
+public:
+    explicit CalculatorService(const ServiceOptions& options = ServiceOptions());
+    ~CalculatorService();
+    CalculatorService(const CalculatorService&) = delete;
+    CalculatorService& operator=(const CalculatorService&) = delete;
+
+    // Serves one session until `read_line` returns false, then returns once every response has
+    // been written. A false return of `write_line` ends the session early.
+    void serve(const std::function<bool(std::string*)>& read_line,
+               const std::function<bool(const std::string&)>& write_line);
+    void serve(std::istream& in, std::ostream& out);
+    void serve(int in_fd, int out_fd);
+
+    // Listens on a Unix-domain socket at `path` (replacing a stale socket file) and serves each
+    // connection as a session on its own thread, until the budget's cancellation token fires.
+    // Throws std::runtime_error if the socket cannot be set up or `path` names something other
+    // than a socket, which is left in place.
+    void listen(const std::string& path);
+
+    // Number of requests answered so far, over all sessions.
+    std::size_t handled() const;
+
+private:
+    ServiceOptions options_;
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable task_ready_;
+    bool stopping_ = false;
+    std::atomic<std::size_t> handled_{0};
+
+    std::future<std::string> submit(std::function<std::string()> task);
+    void work();
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/*
+    Copy-on-write limb storage of BigInt. Copies share one buffer through an atomically
+    reference-counted pointer, so copying a value costs O(1) whatever its size; the buffer is
+    cloned by the first mutating access made while it is shared. Const access never clones.
+
+    Distinct copies may be used from different threads; as with std::vector, a single object
+    must not be mutated while another thread reads it.
+*/
+class SharedLimbs {
+public:
+    using value_type = int;
+    using iterator = std::vector<int>::iterator;
+    using const_iterator = std::vector<int>::const_iterator;
+
+    SharedLimbs() = default;
+    SharedLimbs(std::vector<int> limbs)  // NOLINT
+        : data_(limbs.empty() ? nullptr : std::make_shared<std::vector<int>>(std::move(limbs))) {
+    }
+
+    SharedLimbs& operator=(std::vector<int> limbs) {
+        return *this = SharedLimbs(std::move(limbs));
+    }
+
+    // Read-only access; shares the buffer.
+    operator const std::vector<int>&() const {  // NOLINT
+        return data_ ? *data_ : noLimbs();
+    }
+    const std::vector<int>& get() const {
+        return *this;
+    }
+    std::size_t size() const {
+        return get().size();
+    }
+    bool empty() const {
+        return get().empty();
+    }
+    const int& operator[](std::size_t i) const {
+        return (*data_)[i];
+    }
+    const int& back() const {
+        return data_->back();
+    }
+    const int* data() const {
+        return get().data();
+    }
+    const_iterator begin() const {
+        return get().begin();
+    }
+    const_iterator end() const {
+        return get().end();
+    }
+
+    // Mutating access; clones a shared buffer first. References and iterators obtained here are
+    // invalidated by the next copy of this object.
+    std::vector<int>& mutate() {
+        if (!data_) {
+            data_ = std::make_shared<std::vector<int>>();
+        } else if (data_.use_count() > 1) {
+            data_ = std::make_shared<std::vector<int>>(*data_);
+        } else {
+            // Other owners may have released the buffer just now: their reads happen before
+            // our writes.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *data_;
+    }
+    int& operator[](std::size_t i) {
+        return mutate()[i];
+    }
+    int& back() {
+        return mutate().back();
+    }
+    int* data() {
+        return mutate().data();
+    }
+    iterator begin() {
+        return mutate().begin();
+    }
+    iterator end() {
+        return mutate().end();
+    }
+    void push_back(int limb) {
+        mutate().push_back(limb);
+    }
+    void pop_back() {
+        mutate().pop_back();
+    }
+    void resize(std::size_t size) {
+        mutate().resize(size);
+    }
+    void clear() {
+        data_.reset();
+    }
+    template <typename Iterator>
+    void assign(Iterator first, Iterator last) {
+        *this = std::vector<int>(first, last);
+    }
+
+    // Whether the buffer is currently shared with another value.
+    bool shared() const {
+        return data_.use_count() > 1;
+    }
+
+private:
+    std::shared_ptr<std::vector<int>> data_;  // null for no limbs
+
+    static const std::vector<int>& noLimbs() {
+        static const std::vector<int> kEmpty;
+        return kEmpty;
+    }
+};
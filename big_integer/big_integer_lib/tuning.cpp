@@ -0,0 +1,97 @@
+#include "tuning.h"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+TuningProfile environmentProfile() {
+    const char* path = std::getenv("BIG_INT_TUNING_PROFILE");
+    if (path != nullptr) {
+        try {
+            return TuningProfile::load(path);
+        } catch (const std::exception&) {
+            // An unreadable profile leaves the build-time values in place.
+        }
+    }
+    return TuningProfile();
+}
+
+TuningProfile& mutableProfile() {
+    static TuningProfile profile = environmentProfile();
+    return profile;
+}
+
+}  // namespace
+
+std::string TuningProfile::toString() const {
+    std::ostringstream out;
+    out << "karatsuba_base_case " << karatsuba_base_case << '\n'
+        << "schoolbook_limbs " << schoolbook_limbs << '\n'
+        << "ntt_limbs " << ntt_limbs << '\n'
+        << "ntt_min_limbs " << ntt_min_limbs << '\n'
+        << "binary_division_limbs " << binary_division_limbs << '\n'
+        << "binary_division_ratio " << binary_division_ratio << '\n';
+    return out.str();
+}
+
+TuningProfile TuningProfile::parse(const std::string& text) {
+    TuningProfile profile;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string name;
+        int value = 0;
+        if (!(fields >> name) || name[0] == '#') {
+            continue;
+        }
+        const int minimum = name == "karatsuba_base_case" ? 1 : 0;  // a 0 leaf never ends
+        if (!(fields >> value) || value < minimum) {
+            throw std::invalid_argument("Bad tuning profile line '" + line + "'");
+        }
+        if (name == "karatsuba_base_case") {
+            profile.karatsuba_base_case = value;
+        } else if (name == "schoolbook_limbs") {
+            profile.schoolbook_limbs = value;
+        } else if (name == "ntt_limbs") {
+            profile.ntt_limbs = value;
+        } else if (name == "ntt_min_limbs") {
+            profile.ntt_min_limbs = value;
+        } else if (name == "binary_division_limbs") {
+            profile.binary_division_limbs = value;
+        } else if (name == "binary_division_ratio") {
+            profile.binary_division_ratio = value;
+        } else {
+            throw std::invalid_argument("Unknown tuning parameter '" + name + "'");
+        }
+    }
+    return profile;
+}
+
+TuningProfile TuningProfile::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot read tuning profile " + path);
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    return parse(text.str());
+}
+
+void TuningProfile::save(const std::string& path) const {
+    std::ofstream out(path);
+    out << toString();
+    if (!out) {
+        throw std::runtime_error("Cannot write tuning profile " + path);
+    }
+}
+
+const TuningProfile& TuningProfile::active() {
+    return mutableProfile();
+}
+
+void TuningProfile::setActive(const TuningProfile& profile) {
+    mutableProfile() = profile;
+}
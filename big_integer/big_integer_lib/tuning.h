@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+
+/*
+    Crossover thresholds of the multiplication and division dispatch. The values differ between
+    machines; big_integer_tune measures them and writes a profile of "name value" lines. A
+    profile can be baked in at build time (cmake -DBIG_INT_TUNING_PROFILE=<file>, which defines
+    the macros below) or loaded at startup from the file named by the BIG_INT_TUNING_PROFILE
+    environment variable.
+*/
+
+#ifndef BIG_INT_KARATSUBA_BASE_CASE
+#define BIG_INT_KARATSUBA_BASE_CASE 32
+#endif
+#if BIG_INT_KARATSUBA_BASE_CASE < 1
+#error "BIG_INT_KARATSUBA_BASE_CASE must be at least 1"
+#endif
+#ifndef BIG_INT_SCHOOLBOOK_LIMBS
+#define BIG_INT_SCHOOLBOOK_LIMBS 1024
+#endif
+#ifndef BIG_INT_NTT_LIMBS
+#define BIG_INT_NTT_LIMBS 1536
+#endif
+#ifndef BIG_INT_NTT_MIN_LIMBS
+#define BIG_INT_NTT_MIN_LIMBS 512
+#endif
+#ifndef BIG_INT_BINARY_DIVISION_LIMBS
+#define BIG_INT_BINARY_DIVISION_LIMBS 256
+#endif
+#ifndef BIG_INT_BINARY_DIVISION_RATIO
+#define BIG_INT_BINARY_DIVISION_RATIO 8
+#endif
+
+struct TuningProfile {
+    // Karatsuba recursion stops at this many base-10^6 digits and multiplies by schoolbook;
+    // at least 1.
+    int karatsuba_base_case = BIG_INT_KARATSUBA_BASE_CASE;
+    // operator* multiplies the base-10^9 limbs directly, without repacking, while the shorter
+    // operand has fewer limbs than this.
+    int schoolbook_limbs = BIG_INT_SCHOOLBOOK_LIMBS;
+    // operator* multiplies by number-theoretic transforms, ahead of both schoolbook and
+    // Karatsuba, once the longer operand has ntt_limbs limbs and the shorter one ntt_min_limbs.
+    // The transforms cut the longer operand into chunks, so their cost per limb of it depends
+    // on the shorter one only, as does the cost of schoolbook.
+    int ntt_limbs = BIG_INT_NTT_LIMBS;
+    int ntt_min_limbs = BIG_INT_NTT_MIN_LIMBS;
+    // divmod uses Knuth's algorithm D on binary limbs instead of decimal long division for
+    // dividends shorter than this many limbs. The conversions to and from binary are quadratic
+    // in the dividend while long division is linear in it, so a longer dividend goes binary
+    // only if it has at most binary_division_ratio times as many limbs as the divisor.
+    int binary_division_limbs = BIG_INT_BINARY_DIVISION_LIMBS;
+    int binary_division_ratio = BIG_INT_BINARY_DIVISION_RATIO;
+
+    std::string toString() const;
+    static TuningProfile parse(const std::string& text);  // throws std::invalid_argument
+    static TuningProfile load(const std::string& path);   // throws std::runtime_error
+    void save(const std::string& path) const;
+
+    // The profile of the dispatch: the environment profile if one is set and readable, the
+    // build-time values otherwise. setActive is meant for tools and tests and must not race
+    // with arithmetic on other threads.
+    static const TuningProfile& active();
+    static void setActive(const TuningProfile& profile);
+};
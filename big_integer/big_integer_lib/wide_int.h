@@ -0,0 +1,482 @@
+#pragma once
+
+#include "big_int.h"
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/*
+    Fixed-width integer of `Bits` bits stored in a std::array of 32-bit limbs (least significant
+    limb first). Signed values use two's complement and, like the built-in types, wrap around on
+    overflow. Every operation works on the stack and is usable in constant expressions.
+*/
+template <std::size_t Bits, bool Signed = true>
+class WideInt {
+    static_assert(Bits >= 64 && Bits % 32 == 0, "WideInt width must be a multiple of 32 bits");
+
+public:
+    static constexpr std::size_t kLimbs = Bits / 32;
+    using Limbs = std::array<uint32_t, kLimbs>;
+
+    // Constructors:
+    constexpr WideInt() : limbs_{} {
+    }
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    constexpr WideInt(T number) : limbs_{} {  // NOLINT
+        uint64_t value = static_cast<uint64_t>(number);
+        limbs_[0] = static_cast<uint32_t>(value);
+        limbs_[1] = static_cast<uint32_t>(value >> 32);
+        if (std::is_signed<T>::value && number < 0) {
+            for (std::size_t i = 2; i < kLimbs; ++i) {
+                limbs_[i] = 0xFFFFFFFFu;
+            }
+        }
+    }
+
+    WideInt(const std::string& str) : WideInt(parse(str)) {  // NOLINT
+    }
+
+    template <std::size_t OtherBits, bool OtherSigned>
+    constexpr explicit WideInt(const WideInt<OtherBits, OtherSigned>& number) : limbs_{} {
+        const uint32_t fill = number.isNegative() ? 0xFFFFFFFFu : 0;
+        for (std::size_t i = 0; i < kLimbs; ++i) {
+            limbs_[i] = i < number.kLimbs ? number.limbs_[i] : fill;
+        }
+    }
+
+    // Conversions from and to BigInt; the value is taken modulo 2^Bits:
+    explicit WideInt(const BigInt& number) : limbs_{} {
+        for (int i = static_cast<int>(number.digits_.size()) - 1; i >= 0; --i) {
+            mulAddSmall(&limbs_, BigInt::kBase, number.digits_[i]);
+        }
+        if (number.sign_ == -1) {
+            limbs_ = negated(limbs_);
+        }
+    }
+
+    explicit operator BigInt() const {
+        BigInt result;
+        Limbs magnitude = isNegative() ? negated(limbs_) : limbs_;
+        while (!isZero(magnitude)) {
+            result.digits_.push_back(static_cast<int>(divSmall(&magnitude, BigInt::kBase)));
+        }
+        result.sign_ = isNegative() ? -1 : 1;
+        result.trim();
+        return result;
+    }
+
+    // Unary arithmetic operators:
+    constexpr WideInt operator+() const {
+        return *this;
+    }
+
+    constexpr WideInt operator-() const {
+        return fromLimbs(negated(limbs_));
+    }
+
+    // Arithmetic-assignment operators:
+    constexpr WideInt& operator+=(const WideInt& value) {
+        uint64_t carry = 0;
+        for (std::size_t i = 0; i < kLimbs; ++i) {
+            carry += static_cast<uint64_t>(limbs_[i]) + value.limbs_[i];
+            limbs_[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        return *this;
+    }
+
+    constexpr WideInt& operator-=(const WideInt& value) {
+        uint64_t borrow = 0;
+        for (std::size_t i = 0; i < kLimbs; ++i) {
+            uint64_t cur = static_cast<uint64_t>(limbs_[i]) - value.limbs_[i] - borrow;
+            limbs_[i] = static_cast<uint32_t>(cur);
+            borrow = (cur >> 32) & 1;
+        }
+        return *this;
+    }
+
+    constexpr WideInt& operator*=(const WideInt& value) {
+        Limbs result{};
+        for (std::size_t i = 0; i < kLimbs; ++i) {
+            uint64_t carry = 0;
+            for (std::size_t j = 0; i + j < kLimbs; ++j) {
+                uint64_t cur = static_cast<uint64_t>(limbs_[i]) * value.limbs_[j] +
+                               result[i + j] + carry;
+                result[i + j] = static_cast<uint32_t>(cur);
+                carry = cur >> 32;
+            }
+        }
+        limbs_ = result;
+        return *this;
+    }
+
+    constexpr WideInt& operator/=(const WideInt& value) {
+        return *this = divmod(*this, value).first;
+    }
+
+    constexpr WideInt& operator%=(const WideInt& value) {
+        return *this = divmod(*this, value).second;
+    }
+
+    // Binary arithmetic operators:
+    friend constexpr WideInt operator+(WideInt lhs, const WideInt& rhs) {
+        return lhs += rhs;
+    }
+
+    friend constexpr WideInt operator-(WideInt lhs, const WideInt& rhs) {
+        return lhs -= rhs;
+    }
+
+    friend constexpr WideInt operator*(WideInt lhs, const WideInt& rhs) {
+        return lhs *= rhs;
+    }
+
+    friend constexpr WideInt operator/(const WideInt& lhs, const WideInt& rhs) {
+        return divmod(lhs, rhs).first;
+    }
+
+    friend constexpr WideInt operator%(const WideInt& lhs, const WideInt& rhs) {
+        return divmod(lhs, rhs).second;
+    }
+
+    // Increment and decrement operators:
+    constexpr WideInt& operator++() {
+        return *this += 1;
+    }
+
+    constexpr WideInt& operator--() {
+        return *this -= 1;
+    }
+
+    constexpr WideInt operator++(int) {
+        WideInt old = *this;
+        *this += 1;
+        return old;
+    }
+
+    constexpr WideInt operator--(int) {
+        WideInt old = *this;
+        *this -= 1;
+        return old;
+    }
+
+    // Relational operators:
+    friend constexpr bool operator<(const WideInt& lhs, const WideInt& rhs) {
+        if (lhs.isNegative() != rhs.isNegative()) {
+            return lhs.isNegative();
+        }
+        return compareLimbs(lhs.limbs_, rhs.limbs_) < 0;
+    }
+
+    friend constexpr bool operator>(const WideInt& lhs, const WideInt& rhs) {
+        return rhs < lhs;
+    }
+
+    friend constexpr bool operator<=(const WideInt& lhs, const WideInt& rhs) {
+        return !(rhs < lhs);
+    }
+
+    friend constexpr bool operator>=(const WideInt& lhs, const WideInt& rhs) {
+        return !(lhs < rhs);
+    }
+
+    friend constexpr bool operator==(const WideInt& lhs, const WideInt& rhs) {
+        return compareLimbs(lhs.limbs_, rhs.limbs_) == 0;
+    }
+
+    friend constexpr bool operator!=(const WideInt& lhs, const WideInt& rhs) {
+        return !(lhs == rhs);
+    }
+
+    // I/O stream operators:
+    friend std::istream& operator>>(std::istream& in, WideInt& number) {
+        std::string input;
+        in >> input;
+        number = parse(input);
+        return in;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const WideInt& number) {
+        return out << to_string(number);
+    }
+
+    // Math functions:
+    constexpr WideInt abs() const {  // NOLINT
+        return isNegative() ? -*this : *this;
+    }
+
+    // Truncating division; the remainder has the sign of the dividend, as for BigInt.
+    friend constexpr std::pair<WideInt, WideInt> divmod(const WideInt& a,  // NOLINT
+                                                        const WideInt& b) {
+        if (isZero(b.limbs_)) {
+            throw std::domain_error("Division by zero");
+        }
+        Limbs u = a.isNegative() ? negated(a.limbs_) : a.limbs_;
+        Limbs v = b.isNegative() ? negated(b.limbs_) : b.limbs_;
+        Limbs q{}, r{};
+        divmodMagnitude(u, v, &q, &r);
+        if (a.isNegative() != b.isNegative()) {
+            q = negated(q);
+        }
+        if (a.isNegative()) {
+            r = negated(r);
+        }
+        return {fromLimbs(q), fromLimbs(r)};
+    }
+
+    // Conversion functions:
+    static std::string to_string(const WideInt& number) {  // NOLINT
+        Limbs magnitude = number.isNegative() ? negated(number.limbs_) : number.limbs_;
+        std::string result;
+        do {
+            uint32_t chunk = divSmall(&magnitude, BigInt::kBase);
+            for (int i = 0; i < BigInt::kBaseDigits; ++i) {
+                result.push_back(static_cast<char>('0' + chunk % 10));
+                chunk /= 10;
+                if (!chunk && isZero(magnitude)) {
+                    break;
+                }
+            }
+        } while (!isZero(magnitude));
+        if (number.isNegative()) {
+            result.push_back('-');
+        }
+        return std::string(result.rbegin(), result.rend());
+    }
+
+    static constexpr int to_int(const WideInt& number) {  // NOLINT
+        return static_cast<int>(number.limbs_[0]);
+    }
+
+    static constexpr int64_t to_int64_t(const WideInt& number) {  // NOLINT
+        return static_cast<int64_t>(to_uint64_t(number));
+    }
+
+    static constexpr uint64_t to_uint64_t(const WideInt& number) {  // NOLINT
+        return (static_cast<uint64_t>(number.limbs_[1]) << 32) | number.limbs_[0];
+    }
+
+    // Parses an optionally signed decimal number; throws if it does not fit into the type.
+    static constexpr WideInt parse(const char* str, std::size_t length) {
+        std::size_t pos = 0;
+        bool negative = false;
+        if (length > 0 && (str[0] == '+' || str[0] == '-')) {
+            negative = str[0] == '-';
+            ++pos;
+        }
+        if (pos == length) {
+            throw std::invalid_argument("Expected an integer");
+        }
+        Limbs magnitude{};
+        for (; pos < length; ++pos) {
+            if (str[pos] < '0' || str[pos] > '9') {
+                throw std::invalid_argument("Expected an integer");
+            }
+            if (mulAddSmall(&magnitude, 10, str[pos] - '0')) {
+                throw std::out_of_range("Integer does not fit into WideInt");
+            }
+        }
+        WideInt result = fromLimbs(magnitude);
+        if (Signed && result.isNegative() && !(negative && isMinimum(magnitude))) {
+            throw std::out_of_range("Integer does not fit into WideInt");
+        }
+        if (!Signed && negative && !isZero(magnitude)) {
+            throw std::out_of_range("Integer does not fit into WideInt");
+        }
+        return negative ? -result : result;
+    }
+
+    static WideInt parse(const std::string& str) {
+        try {
+            return parse(str.data(), str.size());
+        } catch (const std::invalid_argument&) {
+            throw std::invalid_argument("Expected an integer, got \'" + str + "\'");
+        }
+    }
+
+    constexpr bool isNegative() const {
+        return Signed && (limbs_[kLimbs - 1] >> 31);
+    }
+
+    constexpr const Limbs& limbs() const {
+        return limbs_;
+    }
+
+    static constexpr WideInt fromLimbs(const Limbs& limbs) {
+        WideInt result;
+        result.limbs_ = limbs;
+        return result;
+    }
+
+private:
+    template <std::size_t, bool>
+    friend class WideInt;
+
+    Limbs limbs_;
+
+    // Utility functions:
+    static constexpr bool isZero(const Limbs& limbs) {
+        for (uint32_t limb : limbs) {
+            if (limb) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static constexpr bool isMinimum(const Limbs& limbs) {
+        for (std::size_t i = 0; i + 1 < kLimbs; ++i) {
+            if (limbs[i]) {
+                return false;
+            }
+        }
+        return limbs[kLimbs - 1] == 0x80000000u;
+    }
+
+    static constexpr Limbs negated(const Limbs& limbs) {
+        Limbs result{};
+        uint64_t carry = 1;
+        for (std::size_t i = 0; i < kLimbs; ++i) {
+            carry += static_cast<uint32_t>(~limbs[i]);
+            result[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        return result;
+    }
+
+    static constexpr int compareLimbs(const Limbs& a, const Limbs& b) {
+        for (std::size_t i = kLimbs; i-- > 0;) {
+            if (a[i] != b[i]) {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    // limbs = limbs * factor + addend; returns the carry out of the top limb.
+    static constexpr uint32_t mulAddSmall(Limbs* limbs, uint32_t factor, uint32_t addend) {
+        uint64_t carry = addend;
+        for (std::size_t i = 0; i < kLimbs; ++i) {
+            carry += static_cast<uint64_t>((*limbs)[i]) * factor;
+            (*limbs)[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        return static_cast<uint32_t>(carry);
+    }
+
+    // limbs = limbs / divisor; returns the remainder.
+    static constexpr uint32_t divSmall(Limbs* limbs, uint32_t divisor) {
+        uint64_t remainder = 0;
+        for (std::size_t i = kLimbs; i-- > 0;) {
+            uint64_t cur = (remainder << 32) | (*limbs)[i];
+            (*limbs)[i] = static_cast<uint32_t>(cur / divisor);
+            remainder = cur % divisor;
+        }
+        return static_cast<uint32_t>(remainder);
+    }
+
+    static constexpr int leadingZeros(uint32_t value) {
+        int count = 0;
+        for (uint32_t bit = 0x80000000u; bit && !(value & bit); bit >>= 1) {
+            ++count;
+        }
+        return count;
+    }
+
+    // Knuth's algorithm D on unsigned magnitudes (The Art of Computer Programming, 4.3.1).
+    static constexpr void divmodMagnitude(const Limbs& u, const Limbs& v, Limbs* q, Limbs* r) {
+        std::size_t n = kLimbs;
+        while (n > 0 && !v[n - 1]) {
+            --n;
+        }
+        std::size_t m = kLimbs;
+        while (m > 0 && !u[m - 1]) {
+            --m;
+        }
+        *q = Limbs{};
+        *r = Limbs{};
+        if (m < n) {
+            *r = u;
+            return;
+        }
+        if (n == 1) {
+            *q = u;
+            (*r)[0] = divSmall(q, v[0]);
+            return;
+        }
+
+        const int shift = leadingZeros(v[n - 1]);
+        std::array<uint32_t, kLimbs> vn{};
+        std::array<uint32_t, kLimbs + 1> un{};
+        for (std::size_t i = n - 1; i > 0; --i) {
+            vn[i] = shift ? (v[i] << shift) | (v[i - 1] >> (32 - shift)) : v[i];
+        }
+        vn[0] = v[0] << shift;
+        un[m] = shift ? u[m - 1] >> (32 - shift) : 0;
+        for (std::size_t i = m - 1; i > 0; --i) {
+            un[i] = shift ? (u[i] << shift) | (u[i - 1] >> (32 - shift)) : u[i];
+        }
+        un[0] = u[0] << shift;
+
+        constexpr uint64_t kRadix = uint64_t(1) << 32;
+        for (std::size_t j = m - n + 1; j-- > 0;) {
+            uint64_t numerator = (static_cast<uint64_t>(un[j + n]) << 32) | un[j + n - 1];
+            uint64_t qhat = numerator / vn[n - 1];
+            uint64_t rhat = numerator % vn[n - 1];
+            while (qhat >= kRadix || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+                --qhat;
+                rhat += vn[n - 1];
+                if (rhat >= kRadix) {
+                    break;
+                }
+            }
+
+            int64_t borrow = 0;
+            int64_t t = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                uint64_t product = qhat * vn[i];
+                t = static_cast<int64_t>(un[i + j]) - borrow -
+                    static_cast<int64_t>(product & 0xFFFFFFFFu);
+                un[i + j] = static_cast<uint32_t>(t);
+                borrow = static_cast<int64_t>(product >> 32) - (t >> 32);
+            }
+            t = static_cast<int64_t>(un[j + n]) - borrow;
+            un[j + n] = static_cast<uint32_t>(t);
+
+            (*q)[j] = static_cast<uint32_t>(qhat);
+            if (t < 0) {
+                --(*q)[j];
+                uint64_t carry = 0;
+                for (std::size_t i = 0; i < n; ++i) {
+                    carry += static_cast<uint64_t>(un[i + j]) + vn[i];
+                    un[i + j] = static_cast<uint32_t>(carry);
+                    carry >>= 32;
+                }
+                un[j + n] += static_cast<uint32_t>(carry);
+            }
+        }
+
+        for (std::size_t i = 0; i < n; ++i) {
+            (*r)[i] = shift ? (un[i] >> shift) | (un[i + 1] << (32 - shift)) : un[i];
+        }
+    }
+};
+
+template <std::size_t Bits>
+using WideUInt = WideInt<Bits, false>;
+
+using Int128 = WideInt<128>;
+using Int256 = WideInt<256>;
+using Int512 = WideInt<512>;
+using Int1024 = WideInt<1024>;
+using UInt128 = WideUInt<128>;
+using UInt256 = WideUInt<256>;
+using UInt512 = WideUInt<512>;
+using UInt1024 = WideUInt<1024>;
@@ -1,209 +1,156 @@
 #include <iostream>
 #include "big_integer_lib/big_int.h"
+#include "big_integer_lib/calculator.h"
+#include "big_integer_lib/service.h"
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <stdexcept>
 #include <string>
 #include <vector>
-#include <stack>
 #include <queue>
-#include <map>
-#include <list>
 #include <iterator>
 
-const int kLeftAssoc = 0;
-const int kRightAssoc = 1;
-
-// Map the different operators: +, -, *, / etc
-typedef std::map<std::string, std::pair<int, int>> OpMap;
-
-const OpMap::value_type kAssocs[] = {
-    OpMap::value_type("+", {0, kLeftAssoc}), OpMap::value_type("-", {0, kLeftAssoc}),
-    OpMap::value_type("*", {5, kLeftAssoc}), OpMap::value_type("/", {5, kLeftAssoc}),
-    OpMap::value_type("%", {5, kLeftAssoc})};
-
-const OpMap kOpmap(kAssocs, kAssocs + sizeof(kAssocs) / sizeof(kAssocs[0]));
-
-bool isParenthesis(const std::string& token) {
-    return token == "(" || token == ")";
-}
+template <typename T, typename InputIterator>
+void print(const std::string& message, const InputIterator& it_begin, const InputIterator& it_end,
+           const std::string& delimiter) {
+    std::cout << message << '\n';
 
-bool isOperator(const std::string& token) {
-    return token == "+" || token == "-" || token == "*" || token == "/" || token == "%";
-}
+    std::copy(it_begin, it_end, std::ostream_iterator<T>(std::cout, delimiter.c_str()));
 
-bool isAssociative(const std::string& token, int type) {
-    const std::pair<int, int> p = kOpmap.find(token)->second;
-    return p.second == type;
+    std::cout << '\n';
 }
 
-int cmpPrecedence(const std::string& token1, const std::string& token2) {
-    const std::pair<int, int> p1 = kOpmap.find(token1)->second;
-    const std::pair<int, int> p2 = kOpmap.find(token2)->second;
+CancellationToken interrupt_token;
 
-    return p1.first - p2.first;
+void interrupt(int) {
+    interrupt_token.cancel();
 }
 
-bool infixToRPN(std::queue<std::string>* input_tokens, int size,
-                std::vector<std::string>* str_array) {
-    bool success = true;
-
-    std::list<std::string> out;
-    std::stack<std::string> stack;
-
-    for (int i = 0; i < size; ++i) {
-        const std::string token = input_tokens->front();
-        input_tokens->pop();
-
-        if (isOperator(token)) {
-            const std::string o1 = token;
-
-            if (!stack.empty()) {
-                std::string o2 = stack.top();
-
-                while (isOperator(o2) &&
-                       ((isAssociative(o1, kLeftAssoc) && cmpPrecedence(o1, o2) == 0) ||
-                        cmpPrecedence(o1, o2) < 0)) {
-                    stack.pop();
-                    out.push_back(o2);
-
-                    if (!stack.empty()) {
-                        o2 = stack.top();
-                    } else {
-                        break;
-                    }
-                }
-            }
-
-            stack.push(o1);
-        } else if (token == "(") {
-            stack.push(token);
-        } else if (token == ")") {
-            std::string top_token = stack.top();
-
-            while (top_token != "(") {
-                out.push_back(top_token);
-                stack.pop();
-                if (stack.empty()) {
-                    break;
-                }
-                top_token = stack.top();
-            }
-
-            if (!stack.empty()) {
-                stack.pop();
-            }
-
-            if (top_token != "(") {
+struct Options {
+    EvaluationBudget budget;
+    bool serve = false;
+    std::string socket_path;
+    std::size_t workers = 0;
+};
+
+// Reads --max-operand-digits=N, --max-result-digits=N, --timeout-ms=N and the service options
+// --serve, --socket=PATH and --workers=N.
+bool parseOptions(int argc, char** argv, Options* options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        if (argument == "--serve") {
+            options->serve = true;
+            continue;
+        }
+        const std::size_t equals = argument.find('=');
+        const std::string option = argument.substr(0, equals);
+        if (equals == std::string::npos || equals + 1 == argument.size()) {
+            return false;
+        }
+        if (option == "--socket") {
+            options->socket_path = argument.substr(equals + 1);
+            continue;
+        }
+        // Numbers are plain decimal digits: strtoull alone would read "abc" as 0 (unlimited).
+        const std::string text = argument.substr(equals + 1);
+        errno = 0;
+        const uint64_t value = std::strtoull(text.c_str(), nullptr, 10);
+        if (text.find_first_not_of("0123456789") != std::string::npos || errno == ERANGE) {
+            return false;
+        }
+        if (option == "--max-operand-digits") {
+            options->budget.max_operand_digits = value;
+        } else if (option == "--max-result-digits") {
+            options->budget.max_result_digits = value;
+        } else if (option == "--timeout-ms") {
+            // Longer than the steady clock can count would overflow the deadline.
+            const auto limit = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::duration::max());
+            if (value > static_cast<uint64_t>(limit.count())) {
                 return false;
             }
+            options->budget.time_limit = std::chrono::milliseconds(value);
+        } else if (option == "--workers") {
+            options->workers = value;
         } else {
-            out.push_back(token);
-        }
-    }
-
-    while (!stack.empty()) {
-        const std::string stack_token = stack.top();
-
-        if (isParenthesis(stack_token)) {
             return false;
         }
-        out.push_back(stack_token);
-        stack.pop();
     }
-
-    str_array->assign(out.begin(), out.end());
-    return success;
+    return true;
 }
 
-BigInt rpNtoBigInt(const std::vector<std::string>& tokens) {
-    std::stack<std::string> st;
-
-    for (const std::string& token : tokens) {
-        if (!isOperator(token)) {
-            st.push(token);
+// Service mode: one response line per request line, from stdin or a Unix-domain socket, until
+// the input ends or Ctrl-C.
+int serve(const Options& options) {
+    ServiceOptions service_options;
+    service_options.workers = options.workers;
+    service_options.budget = options.budget;
+    CalculatorService service(service_options);
+    try {
+        if (options.socket_path.empty()) {
+            service.serve(0, 1);
         } else {
-            BigInt result;
-
-            const std::string val2 = st.top();
-            st.pop();
-            const BigInt d2(val2);
-
-            if (!st.empty()) {
-                const std::string val1 = st.top();
-                st.pop();
-                const BigInt d1(val1);
-
-                result = token == "+"   ? d1 + d2
-                         : token == "-" ? d1 - d2
-                         : token == "*" ? d1 * d2
-                         : token == "/" ? d1 / d2
-                                        : d1 % d2;
-            } else {
-                if (token == "-") {
-                    result = -d2;
-                } else {
-                    result = d2;
-                }
-            }
-            st.push(BigInt::to_string(result));
+            service.listen(options.socket_path);
         }
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << '\n';
+        return 1;
     }
-
-    return BigInt(st.top());
+    return 0;
 }
 
-std::queue<std::string> getExpressionTokens(const std::string& expression) {
-    std::queue<std::string> tokens;
-    std::string str;
-    for (char expression_char : expression) {
-        const std::string token(1, expression_char);
-
-        if (isOperator(token) || isParenthesis(token)) {
-            if (!str.empty()) {
-                tokens.push(str);
-            }
-            str.clear();
-            tokens.push(token);
-        } else {
-            if (!token.empty() && token != " " && token != "\t") {
-                str.append(token);
-            } else {
-                if (!str.empty()) {
-                    tokens.push(str);
-                    str.clear();
-                }
-            }
-        }
+// Every input line is either an assignment "name = expression", which is recorded without being
+// evaluated, or an expression over literals and the variables defined so far. Ctrl-C stops the
+// evaluation in progress. --serve and --socket switch to the pipelined service mode.
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, &options)) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--max-operand-digits=N] [--max-result-digits=N] [--timeout-ms=N]"
+                     " [--serve | --socket=PATH] [--workers=N]\n";
+        return 1;
     }
-    if (!str.empty()) {
-        tokens.push(str);
+    options.budget.cancellation = &interrupt_token;
+    std::signal(SIGINT, interrupt);
+    if (options.serve || !options.socket_path.empty()) {
+        return serve(options);
     }
-    return tokens;
-}
+    const EvaluationBudget& budget = options.budget;
 
-template <typename T, typename InputIterator>
-void print(const std::string& message, const InputIterator& it_begin, const InputIterator& it_end,
-           const std::string& delimiter) {
-    std::cout << message << '\n';
-
-    std::copy(it_begin, it_end, std::ostream_iterator<T>(std::cout, delimiter.c_str()));
-
-    std::cout << '\n';
-}
-
-int main() {
+    FormulaEngine engine;
+    engine.setBudget(budget);
     std::string s;
-    std::getline(std::cin, s);
-
-    print<char, std::string::iterator>("Input expression:", s.begin(), s.end(), "");
+    while (std::getline(std::cin, s)) {
+        if (s.find_first_not_of(" \t") == std::string::npos) {
+            continue;
+        }
+        interrupt_token.reset();
+        try {
+            std::string name, expression;
+            if (FormulaEngine::parseAssignment(s, &name, &expression)) {
+                engine.assign(name, expression);
+                std::cout << "Defined " << name << '\n';
+                continue;
+            }
 
-    std::queue<std::string> tokens = getExpressionTokens(s);
-    std::vector<std::string> rpn;
-    if (infixToRPN(&tokens, tokens.size(), &rpn)) {
-        BigInt big_integer = rpNtoBigInt(rpn);
-        print<std::string, std::vector<std::string>::const_iterator>("RPN tokens:", rpn.begin(),
-                                                                     rpn.end(), " ");
-        std::cout << "Result = " << big_integer << '\n';
-    } else {
-        std::cout << "Mis-match in parentheses" << '\n';
+            print<char, std::string::iterator>("Input expression:", s.begin(), s.end(), "");
+
+            std::queue<std::string> tokens = getExpressionTokens(s);
+            std::vector<std::string> rpn;
+            if (infixToRPN(&tokens, tokens.size(), &rpn)) {
+                BigInt big_integer = evaluateRPN(
+                    rpn, [&engine](const std::string& name) { return engine.value(name); },
+                    budget);
+                print<std::string, std::vector<std::string>::const_iterator>(
+                    "RPN tokens:", rpn.begin(), rpn.end(), " ");
+                std::cout << "Result = " << big_integer << '\n';
+            } else {
+                std::cout << "Mis-match in parentheses" << '\n';
+            }
+        } catch (const std::exception& error) {
+            std::cout << "Error: " << error.what() << '\n';
+        }
     }
     return 0;
 }
@@ -1,6 +1,26 @@
 #include <cassert>
+#include <fstream>
 #include <limits>
+#include <thread>
+#include <sstream>
+#include <unordered_map>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 #include "big_integer_lib/big_int.h"
+#include "big_integer_lib/wide_int.h"
+#include "big_integer_lib/big_int_literals.h"
+#include "big_integer_lib/big_int_array.h"
+#include "big_integer_lib/combinatorics.h"
+#include "big_integer_lib/modular.h"
+#include "big_integer_lib/divisor.h"
+#include "big_integer_lib/prepared_multiplier.h"
+#include "big_integer_lib/number_theory.h"
+#include "big_integer_lib/primality.h"
+#include "big_integer_lib/rns.h"
+#include "big_integer_lib/calculator.h"
+#include "big_integer_lib/service.h"
+#include "big_integer_lib/tuning.h"
 #include <gtest/gtest.h>
 
 TEST(Constructor, Test1) {
@@ -182,3 +202,1015 @@ TEST(Equal, Test6) {
 
     ASSERT_EQ(BigInt(0), 0);
 }
+
+TEST(WideInt, Test7) {
+    constexpr Int256 kA = Int256::parse("123456789101112131415161718192021", 33);
+    constexpr Int256 kB = Int256(-987654321) * 1'000'000'007;
+    static_assert(kA / kA == 1, "constexpr division");
+    static_assert(kB < 0 && kB % 1'000'000'007 == 0, "constexpr remainder");
+
+    BigInt a("123456789101112131415161718192021");
+    BigInt b("-185472482954376984235728912432574952364745901");
+    Int256 wa(a);
+    Int256 wb(b);
+    ASSERT_EQ(wa, kA);
+    ASSERT_EQ(Int256::to_string(wb), BigInt::to_string(b));
+
+    ASSERT_EQ(BigInt(wa + wb), a + b);
+    ASSERT_EQ(BigInt(wa - wb), a - b);
+    ASSERT_EQ(BigInt(wb * 12345), b * 12345);
+    ASSERT_EQ(BigInt(wb / wa), b / a);
+    ASSERT_EQ(BigInt(wb % wa), b % a);
+    ASSERT_EQ(BigInt(wb / -7), b / -7);
+    ASSERT_EQ(BigInt(wb % 7), b % 7);
+    ASSERT_EQ(BigInt(-wb), -b);
+    ASSERT_EQ(BigInt(wb.abs()), b.abs());
+
+    ASSERT_LT(wb, wa);
+    ASSERT_GT(wa, 0);
+    ASSERT_LE(wb, wb);
+    ASSERT_NE(wa, wb);
+
+    Int256 counter = 0;
+    ASSERT_EQ(counter++, 0);
+    ASSERT_EQ(++counter, 2);
+    ASSERT_EQ(--counter, 1);
+
+    UInt128 max = -UInt128(1);
+    ASSERT_EQ(UInt128::to_string(max), "340282366920938463463374607431768211455");
+    ASSERT_EQ(max + 1, 0);
+    ASSERT_EQ(UInt128(max / UInt128(std::numeric_limits<uint64_t>::max())),
+              UInt128(std::numeric_limits<uint64_t>::max()) + 2);
+
+    Int128 min = Int128("-170141183460469231731687303715884105728");
+    ASSERT_EQ(Int128::to_string(min), "-170141183460469231731687303715884105728");
+    ASSERT_EQ(min - 1, -min - 1);
+    ASSERT_THROW(Int128("170141183460469231731687303715884105728"), std::out_of_range);
+    ASSERT_THROW(Int128("12a"), std::invalid_argument);
+    ASSERT_THROW(wa / 0, std::domain_error);
+
+    Int512 wide(wb);
+    ASSERT_EQ(BigInt(wide * wide), b * b);
+    ASSERT_EQ(Int256(wide), wb);
+}
+
+// Whether the raw characters of a literal token pick a literal operator; SFINAE keeps a
+// rejected token from being a hard error here.
+template <char... Chars>
+constexpr auto isBigLiteral(int) -> decltype(big_int_literals::operator""_big<Chars...>(), true) {
+    return true;
+}
+
+template <char... Chars>
+constexpr bool isBigLiteral(...) {
+    return false;
+}
+
+template <char... Chars>
+constexpr auto isU256Literal(int)
+    -> decltype(big_int_literals::operator""_u256<Chars...>(), true) {
+    return true;
+}
+
+template <char... Chars>
+constexpr bool isU256Literal(...) {
+    return false;
+}
+
+TEST(Literals, Test8) {
+    using namespace big_int_literals;  // NOLINT
+
+    ASSERT_EQ(123456789101112131415_big, BigInt("123456789101112131415"));
+    ASSERT_EQ(-1'000'000'000'000'000'000'000_big, BigInt("-1000000000000000000000"));
+    ASSERT_EQ(0_big, 0);
+    ASSERT_EQ(0xFFFFFFFFFFFFFFFF_big, BigInt(std::numeric_limits<uint64_t>::max()));
+    ASSERT_EQ(0x1000000000000000000000000_big * 1, BigInt("79228162514264337593543950336"));
+    ASSERT_EQ(0b1010_big, 10);
+    ASSERT_EQ(0777_big, 511);
+
+    static_assert(isBigLiteral<'1', '\'', '0', '0', '0'>(0), "1'000");
+    static_assert(isBigLiteral<'0', 'x', 'F', 'f'>(0), "0xFf");
+    static_assert(!isBigLiteral<'1', '.', '5'>(0), "1.5");
+    static_assert(!isBigLiteral<'1', 'e', '5'>(0), "1e5");
+    static_assert(!isBigLiteral<'0', 'x', '1', 'p', '3'>(0), "0x1p3");
+    static_assert(!isBigLiteral<'0', '8'>(0), "08");
+    static_assert(!isBigLiteral<'0', 'b', '1', '2'>(0), "0b12");
+    static_assert(!isU256Literal<'1', '.', '5'>(0), "1.5");
+    static_assert(!isU256Literal<'0', '9'>(0), "09");
+
+    constexpr UInt256 kPrime =
+        0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEFFFFFC2F_u256;
+    constexpr UInt256 kPowersOfTen[] = {1_u256, 10_u256, 100'000'000'000'000'000'000_u256};
+    static_assert(kPrime % 2 == 1, "constexpr literal");
+    static_assert(kPowersOfTen[2] / kPowersOfTen[1] == 10'000'000'000'000'000'000_u256, "table");
+    ASSERT_EQ(UInt256::to_string(kPrime),
+              "115792089237316195423570985008687907853269984665640564039457584007908834671663");
+    ASSERT_EQ(BigInt(-170141183460469231731687303715884105727_i128),
+              -170141183460469231731687303715884105727_big);
+}
+
+TEST(Serialization, Test9) {
+    std::vector<BigInt> values = {BigInt(0), BigInt("-123456789101112131415"),
+                                  BigInt(std::numeric_limits<int64_t>::min()),
+                                  BigInt("1000000000000000000000000000000000")};
+    for (const BigInt& value : values) {
+        const std::string bytes = BigInt::serialize(value);
+        ASSERT_EQ(BigInt::deserialize(bytes), value);
+    }
+    ASSERT_EQ(BigInt::serialize(BigInt("-123456789101112131415")).size(), 17u);
+    ASSERT_THROW(BigInt::deserialize(""), std::invalid_argument);
+    ASSERT_THROW(BigInt::deserialize(BigInt::serialize(BigInt(1)).substr(0, 6)),
+                 std::invalid_argument);
+
+    const std::string path = ::testing::TempDir() + "big_int_array.bin";
+    MappedBigIntArray::write(path, values);
+    MappedBigIntArray array(path);
+    ASSERT_EQ(array.size(), values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(array[i].toBigInt(), values[i]);
+    }
+    ASSERT_TRUE(array[1].isNegative());
+    ASSERT_EQ(array[1].size(), 3u);
+    ASSERT_EQ(array[1].limb(0), 101112131415u % 1000000000u);
+    ASSERT_THROW(array[values.size()], std::out_of_range);
+}
+
+TEST(Compare, Test10) {
+    BigInt a("123456789101112131415");
+    BigInt b("-123456789101112131415");
+    ASSERT_EQ(a.compare(a), 0);
+    ASSERT_GT(a.compare(b), 0);
+    ASSERT_LT(b.compare(a), 0);
+    ASSERT_LT(BigInt(5).compare(BigInt(7)), 0);
+    ASSERT_GT(BigInt(-5).compare(BigInt(-7)), 0);
+
+    ASSERT_EQ(BigInt(std::numeric_limits<int64_t>::min()).compare(
+                  std::numeric_limits<int64_t>::min()),
+              0);
+    ASSERT_LT(BigInt(std::numeric_limits<int64_t>::min()) - 1,
+              std::numeric_limits<int64_t>::min());
+    ASSERT_GT(BigInt(std::numeric_limits<int64_t>::max()) + 1,
+              std::numeric_limits<int64_t>::max());
+    ASSERT_GT(a.compare(std::numeric_limits<int64_t>::max()), 0);
+    ASSERT_LT(b.compare(std::numeric_limits<int64_t>::min()), 0);
+    ASSERT_EQ(BigInt(-1000000000).compare(-1000000000), 0);
+
+    std::hash<BigInt> hasher;
+    ASSERT_EQ(hasher(a), hasher(BigInt("123456789101112131415")));
+    ASSERT_NE(hasher(a), hasher(b));
+    std::unordered_map<BigInt, int> counts;
+    for (int i = 0; i < 1000; ++i) {
+        ++counts[BigInt(i % 100) * a];
+    }
+    ASSERT_EQ(counts.size(), 100u);
+    ASSERT_EQ(counts[a * 42], 10);
+}
+
+TEST(MultiplyAccumulate, Test11) {
+    BigInt a("185472482954376984235728912432574952364745901482584172538415819427175865915691");
+    BigInt b("-123456789876543212345678987654321");
+    BigInt acc("999999999999999999999999999");
+
+    BigInt expected = acc + a * b;
+    addmul(&acc, a, b);
+    ASSERT_EQ(acc, expected);
+    submul(&acc, a, b);
+    ASSERT_EQ(acc, BigInt("999999999999999999999999999"));
+    submul(&acc, b, b);
+    ASSERT_EQ(acc, BigInt("999999999999999999999999999") - b * b);
+
+    std::vector<BigInt> xs, ys;
+    BigInt naive = 0;
+    BigInt big = a * a * a * a * a * a * a * a * a * a;  // large enough for the Karatsuba path
+    for (int i = 0; i < 100; ++i) {
+        xs.push_back(i % 3 == 0 ? -a * i : a + i);
+        ys.push_back(i % 7 == 0 ? big + i : BigInt(i) * b);
+        naive += xs.back() * ys.back();
+    }
+    ASSERT_EQ(dot(xs, ys), naive);
+    ASSERT_EQ(dot({}, {}), 0);
+    ASSERT_THROW(dot(xs, {}), std::invalid_argument);
+
+    BigInt max_limbs("999999999999999999999999999999999999999999999999999999999999999999999999");
+    std::vector<BigInt> many(40, max_limbs);
+    ASSERT_EQ(dot(many, many), max_limbs * max_limbs * 40);
+}
+
+TEST(Combinatorics, Test12) {
+    std::vector<BigInt> values;
+    BigInt naive_product = 1;
+    BigInt naive_sum = 0;
+    for (int i = 1; i <= 500; ++i) {
+        values.push_back(BigInt(i) * 1'000'000'007 - (i % 2 ? 0 : 2'000'000'014));
+        naive_product *= values.back();
+        naive_sum += values.back();
+    }
+    ASSERT_EQ(product(values), naive_product);
+    ASSERT_EQ(sum(values), naive_sum);
+    ASSERT_EQ(product({}), 1);
+    ASSERT_EQ(sum({}), 0);
+
+    BigInt naive_factorial = 1;
+    for (uint32_t n = 0; n <= 300; ++n) {
+        if (n > 0) {
+            naive_factorial *= n;
+        }
+        ASSERT_EQ(factorial(n), naive_factorial);
+    }
+    ASSERT_EQ(BigInt::to_string(factorial(25)), "15511210043330985984000000");
+
+    ASSERT_EQ(binomial(0, 0), 1);
+    ASSERT_EQ(binomial(5, 7), 0);
+    ASSERT_EQ(binomial(52, 5), 2598960);
+    ASSERT_EQ(binomial(300, 150), factorial(300) / (factorial(150) * factorial(150)));
+    ASSERT_EQ(binomial(1000, 3), BigInt(1000) * 999 * 998 / 6);
+}
+
+TEST(Power, Test13) {
+    BigInt x("-123456789101112131415");
+    BigInt naive = 1;
+    for (uint64_t e = 0; e <= 70; ++e) {
+        ASSERT_EQ(pow(x, e), naive);
+        naive *= x;
+    }
+    ASSERT_EQ(pow(BigInt(2), 1000), BigInt(
+        "10715086071862673209484250490600018105614048117055336074437503883703510511249361224931983"
+        "78815695858127594672917553146825187145285692314043598457757469857480393456777482423098542"
+        "10746050623711418779541821530464749835819412673987675591655439460770629145711964776865421"
+        "67660429831652624386837205668069376"));
+    ASSERT_EQ(pow(BigInt(0), 0), 1);
+
+    BigInt m("1000000000000000000000000000000000000000000000000000000000000000000000007");
+    BigInt base("98765432109876543210987654321098765432109876543210");
+    BigInt expected = 1;
+    for (int e = 0; e <= 40; ++e) {
+        ASSERT_EQ(powmod(base, e, m), expected);
+        ASSERT_EQ(powmod(base, e, m * 1024), pow(base, e) % (m * 1024));
+        BigInt residue = pow(-base, e) % (m * 96);
+        ASSERT_EQ(powmod(-base, e, m * 96), residue < 0 ? residue + m * 96 : residue);
+        expected = expected * base % m;
+    }
+    // Fermat's little theorem for the Mersenne prime 2^521 - 1.
+    BigInt p = pow(BigInt(2), 521) - 1;
+    ASSERT_EQ(powmod(base, p - 1, p), 1);
+    ASSERT_EQ(powmod(base, p, p), base);
+    ASSERT_EQ(powmod(base, 12345, 1), 0);
+    ASSERT_EQ(powmod(3, 200, BigInt("18446744073709551616")),
+              pow(BigInt(3), 200) % BigInt("18446744073709551616"));
+    ASSERT_THROW(powmod(base, 3, 0), std::domain_error);
+    ASSERT_THROW(powmod(base, -3, m), std::domain_error);
+}
+
+TEST(Modulus, Test14) {
+    BigInt x("-98765432109876543210987654321098765432109876543210987654321098765432109876543210");
+    BigInt y("12345678901234567890123456789012345678901234567890");
+    for (const BigInt& m : {BigInt(7), BigInt(1) * 1024, BigInt(1),
+                            BigInt("1000000000000000000000000000000000000000000000000000000000007"),
+                            BigInt("4294967296"), BigInt("-340282366920938463463374607431768211456"),
+                            pow(BigInt(2), 127) - 1, pow(BigInt(10), 40) * 6}) {
+        Modulus modulus(m);
+        const BigInt abs_m = m.abs();
+        auto residue = [&abs_m](const BigInt& v) {
+            BigInt r = v % abs_m;
+            return r < 0 ? r + abs_m : r;
+        };
+        ASSERT_EQ(modulus.reduce(x), residue(x));
+        ASSERT_EQ(modulus.reduce(y), residue(y));
+        ASSERT_EQ(modulus.reduce(x * x * x), residue(x * x * x));
+        ASSERT_EQ(modulus.mulmod(x, y), residue(x * y));
+        ASSERT_EQ(modulus.addmod(x, y), residue(x + y));
+        ASSERT_EQ(modulus.submod(y, x), residue(y - x));
+        ASSERT_EQ(modulus.submod(x, y), residue(x - y));
+        ASSERT_EQ(modulus.powmod(y, 100), residue(pow(y, 100)));
+        ASSERT_EQ(modulus.powmod(x, 37), powmod(x, 37, m));
+
+        Modulus::Residue a = modulus.toResidue(x);
+        Modulus::Residue b = modulus.toResidue(y);
+        Modulus::Residue c = modulus.zero();
+        modulus.mul(a, b, &c);
+        modulus.add(c, a, &c);
+        modulus.sub(c, b, &c);
+        modulus.mul(c, c, &c);
+        ASSERT_EQ(modulus.fromResidue(c), residue((x * y + x - y) * (x * y + x - y)));
+        ASSERT_EQ(modulus.fromResidue(modulus.one()), residue(1));
+    }
+    ASSERT_THROW(Modulus(0), std::domain_error);
+}
+
+TEST(Divisor, Test15) {
+    BigInt x("-98765432109876543210987654321098765432109876543210987654321098765432109876543210");
+    for (int64_t d : {int64_t(1), int64_t(-1), int64_t(7), int64_t(10), int64_t(1'000'000'000),
+                      int64_t(-1'000'000'007), int64_t(4'294'967'291),
+                      std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min(),
+                      int64_t(1) << 62}) {
+        Divisor divisor(d);
+        for (const BigInt& value : {x, -x, BigInt(0), BigInt(d), x * x + 12345}) {
+            auto expected = divmod(value, BigInt(d));
+            auto actual = divmod(value, divisor);
+            ASSERT_EQ(actual.first, expected.first);
+            ASSERT_EQ(actual.second, expected.second);
+            ASSERT_EQ(value / divisor, expected.first);
+            ASSERT_EQ(value % divisor, expected.second);
+            ASSERT_EQ(divisor.remainder(value), BigInt::to_int64_t(expected.second));
+        }
+    }
+    ASSERT_THROW(Divisor(0), std::domain_error);
+}
+
+TEST(Gcd, Test16) {
+    BigInt p = pow(BigInt(2), 127) - 1;
+    BigInt q = pow(BigInt(3), 100) + 2;
+    BigInt r = BigInt("123456789101112131415");
+    ASSERT_EQ(gcd(p * r, q * r), r);
+    ASSERT_EQ(gcd(-p * r * r, q * r), r);
+    ASSERT_EQ(gcd(factorial(300), pow(BigInt(2), 1000)), pow(BigInt(2), 296));
+    ASSERT_EQ(gcd(0, 0), 0);
+    ASSERT_EQ(gcd(0, -q), q);
+    ASSERT_EQ(gcd(12, 18), 6);
+    ASSERT_EQ(gcd(pow(BigInt(10), 500), pow(BigInt(6), 400)), pow(BigInt(2), 400));
+
+    for (const auto& operands : {std::make_pair(p * r, q * r), std::make_pair(-q, p),
+                                 std::make_pair(BigInt(240), BigInt(-46)),
+                                 std::make_pair(BigInt(0), BigInt(-5)),
+                                 std::make_pair(BigInt(7), BigInt(0)),
+                                 std::make_pair(factorial(200), pow(q, 3) * 10)}) {
+        BigInt g, s, t;
+        std::tie(g, s, t) = gcdext(operands.first, operands.second);
+        ASSERT_EQ(g, gcd(operands.first, operands.second));
+        ASSERT_EQ(s * operands.first + t * operands.second, g);
+    }
+
+    BigInt inverse = invmod(q, p);
+    ASSERT_EQ((inverse * q) % p, 1);
+    ASSERT_GE(inverse, 0);
+    ASSERT_EQ(invmod(-3, 7), 2);
+    ASSERT_THROW(invmod(6, 9), std::domain_error);
+    ASSERT_THROW(invmod(6, 0), std::domain_error);
+}
+
+TEST(Roots, Test17) {
+    for (int64_t i = 0; i < 2000; ++i) {
+        const BigInt root = isqrt(i);
+        ASSERT_LE(root * root, i);
+        ASSERT_GT((root + 1) * (root + 1), i);
+        ASSERT_EQ(is_perfect_square(i), root * root == i);
+    }
+    BigInt x("123456789101112131415161718192021222324252627282930");
+    BigInt square = x * x;
+    ASSERT_EQ(isqrt(square), x);
+    ASSERT_EQ(isqrt(square - 1), x - 1);
+    ASSERT_EQ(isqrt(square + x * 2), x);
+    ASSERT_TRUE(is_perfect_square(square));
+    ASSERT_FALSE(is_perfect_square(square + 1));
+    ASSERT_FALSE(is_perfect_square(-square));
+    BigInt big = pow(BigInt(10), 2001);
+    BigInt root = isqrt(big);
+    ASSERT_LE(root * root, big);
+    ASSERT_GT((root + 1) * (root + 1), big);
+
+    for (uint32_t k = 1; k <= 7; ++k) {
+        BigInt p = pow(x, k);
+        ASSERT_EQ(iroot(p, k), x);
+        ASSERT_EQ(iroot(p - 1, k), k == 1 ? p - 1 : x - 1);
+        ASSERT_EQ(iroot(p + 1, k), k == 1 ? p + 1 : x);
+    }
+    ASSERT_EQ(iroot(pow(BigInt(-x), 3), 3), -x);
+    ASSERT_EQ(iroot(BigInt(1000), 50), 1);
+    // bits / 2 < k < bits: the root is 2 or 3.
+    ASSERT_EQ(iroot(pow(BigInt(2), 100), 60), 3);
+    ASSERT_EQ(iroot(pow(BigInt(3), 200), 100), 9);
+    ASSERT_EQ(iroot(pow(BigInt(3), 200) - 1, 100), 8);
+    ASSERT_EQ(iroot(pow(BigInt(2), 100), 99), 2);
+    ASSERT_EQ(iroot(BigInt(0), 3), 0);
+    ASSERT_EQ(iroot(std::numeric_limits<uint64_t>::max(), 2), 4294967295u);
+    ASSERT_THROW(isqrt(-1), std::domain_error);
+    ASSERT_THROW(iroot(-8, 2), std::domain_error);
+    ASSERT_THROW(iroot(8, 0), std::domain_error);
+}
+
+TEST(Primality, Test18) {
+    const int64_t from = int64_t(kSieveLimit) * kSieveLimit - 10000;
+    const int64_t count = 20000;
+    std::vector<bool> sieve(count, true);
+    for (int64_t p = 2; p * p < from + count; ++p) {
+        for (int64_t multiple = std::max(p * p, (from + p - 1) / p * p); multiple < from + count;
+             multiple += p) {
+            sieve[multiple - from] = false;
+        }
+    }
+    std::vector<BigInt> candidates;
+    for (int64_t i = 0; i < count; ++i) {
+        candidates.emplace_back(from + i);
+    }
+    const std::vector<bool> batch = are_probable_primes(candidates);
+    for (int64_t i = 0; i < count; ++i) {
+        ASSERT_EQ(batch[i], sieve[i]) << from + i;
+        ASSERT_EQ(is_probable_prime(candidates[i]), sieve[i]) << from + i;
+    }
+
+    ASSERT_FALSE(is_probable_prime(0));
+    ASSERT_FALSE(is_probable_prime(1));
+    ASSERT_FALSE(is_probable_prime(-7));
+    ASSERT_TRUE(is_probable_prime(2));
+    ASSERT_TRUE(is_probable_prime(4093));
+    ASSERT_FALSE(is_probable_prime(561));
+    ASSERT_FALSE(is_probable_prime(3215031751));  // strong pseudoprime to bases 2, 3, 5, 7
+    ASSERT_FALSE(is_probable_prime(4294967297));  // 641 * 6700417
+    ASSERT_FALSE(is_probable_prime(BigInt(4099) * 4099));
+    ASSERT_TRUE(is_probable_prime(pow(BigInt(2), 127) - 1));
+    ASSERT_FALSE(is_probable_prime(pow(BigInt(2), 128) + 1));
+    ASSERT_TRUE(is_probable_prime(pow(BigInt(2), 521) - 1));
+    ASSERT_FALSE(is_probable_prime((pow(BigInt(2), 89) - 1) * (pow(BigInt(2), 107) - 1)));
+    ASSERT_FALSE(is_probable_prime((pow(BigInt(2), 127) - 1) * (pow(BigInt(2), 127) - 1)));
+
+    ASSERT_EQ(next_prime(-5), 2);
+    ASSERT_EQ(next_prime(2), 3);
+    ASSERT_EQ(next_prime(13), 17);
+    ASSERT_EQ(next_prime(pow(BigInt(10), 100)), pow(BigInt(10), 100) + 267);
+    ASSERT_EQ(next_prime(pow(BigInt(2), 127) - 2), pow(BigInt(2), 127) - 1);
+}
+
+TEST(ExactDivision, Test19) {
+    const BigInt a("-98765432109876543210987654321098765432109876543210");
+    const BigInt b("12345678901234567890123456789");
+    ASSERT_EQ(divexact(a * b, b), a);
+    ASSERT_EQ(divexact(a * b, a), b);
+    ASSERT_EQ(divexact(a * b, -b), -a);
+    ASSERT_EQ(divexact(b, b), 1);
+    ASSERT_EQ(divexact(0, b), 0);
+    ASSERT_EQ(divexact(BigInt(1024) * 3, 96), 32);
+    ASSERT_EQ(divexact(pow(BigInt(2), 200) * 7, pow(BigInt(2), 190)), 7168);
+    ASSERT_EQ(divexact(factorial(60), factorial(30) * factorial(30)), binomial(60, 30));
+    ASSERT_THROW(divexact(a, 0), std::domain_error);
+    // Divisors coprime to 10 after their zero limbs are divided on the decimal limbs.
+    const BigInt c = -pow(BigInt(3), 20000) - 2;
+    const BigInt d = pow(BigInt(7), 9000) * pow(BigInt(10), 27);
+    ASSERT_EQ(divexact(c * d, d), c);
+    ASSERT_EQ(divexact(c * d, c), d);
+    ASSERT_EQ(divexact(c * d * 20, d * 4), c * 5);
+    const BigInt e = pow(BigInt(2), 1000) * pow(BigInt(5), 37) * 7;
+    ASSERT_EQ(divexact(c * e, e), c);
+    ASSERT_EQ(divexact(e * d, -e * 5), -d / 5);
+    ASSERT_EQ(divexact(pow(BigInt(10), 50), pow(BigInt(5), 50)), pow(BigInt(2), 50));
+    for (int64_t x = -40; x <= 40; ++x) {
+        for (int64_t y = 1; y <= 40; ++y) {
+            ASSERT_EQ(divexact(x * y, y), x);
+            ASSERT_EQ(divexact(x * y, -y), -x);
+        }
+    }
+}
+
+TEST(Bitwise, Test20) {
+    const std::vector<int64_t> values = {0, 1, -1, 2, -2, 7, -8, 255, -256, 1000000000,
+                                         -999999999, 123456789012345, -98765432109876};
+    for (int64_t a : values) {
+        for (std::size_t k = 0; k < 40; ++k) {
+            ASSERT_EQ(BigInt(a) >> k, a >> k) << a << " >> " << k;
+            if (a >= -(int64_t(1) << 22) && a < (int64_t(1) << 22)) {
+                ASSERT_EQ(BigInt(a) << k, a * (int64_t(1) << k)) << a << " << " << k;
+            }
+            ASSERT_EQ(BigInt(a).test_bit(k), ((a >> k) & 1) != 0);
+        }
+        for (int64_t b : values) {
+            ASSERT_EQ(BigInt(a) & BigInt(b), a & b);
+            ASSERT_EQ(BigInt(a) | BigInt(b), a | b);
+            ASSERT_EQ(BigInt(a) ^ BigInt(b), a ^ b);
+        }
+        ASSERT_EQ(~BigInt(a), ~a);
+    }
+    ASSERT_EQ(BigInt(0).bit_length(), 0u);
+    ASSERT_EQ(BigInt(-1).bit_length(), 1u);
+    ASSERT_EQ(BigInt(255).bit_length(), 8u);
+    ASSERT_EQ(BigInt(256).bit_length(), 9u);
+    ASSERT_EQ(BigInt(-98765432109876).popcount(), 29u);
+    ASSERT_EQ(BigInt(96).trailing_zeros(), 5u);
+    ASSERT_EQ(BigInt(0).trailing_zeros(), 0u);
+
+    const BigInt x("-123456789101112131415161718192021222324252627282930");
+    const BigInt power = pow(BigInt(2), 300);
+    for (std::size_t k : {0, 1, 29, 64, 100, 232, 233, 300, 1000}) {
+        ASSERT_EQ(x << k, x * pow(BigInt(2), k));
+        ASSERT_EQ((x << k).trailing_zeros(), k + x.trailing_zeros());
+        ASSERT_EQ(x * pow(BigInt(2), k) >> k, x);
+        ASSERT_EQ((x >> (k / 2)) >> (k - k / 2), x >> k);
+        ASSERT_EQ((-x >> k), divmod(-x, pow(BigInt(2), k)).first);
+        ASSERT_EQ((power << k).bit_length(), 301 + k);
+        ASSERT_EQ(((power << k) - 1).bit_length(), 300 + k);
+        ASSERT_EQ(((power << k) - 1).popcount(), 300 + k);
+    }
+    ASSERT_EQ(x >> 1000, -1);
+    ASSERT_EQ(-x >> 1000, 0);
+    const BigInt z = pow(x, 20) + 12345;
+    for (std::size_t k : {233, 243, 900, 1234, 3006, 3350, 3371, 3400, 6000}) {
+        const BigInt power_k = pow(BigInt(2), k);
+        ASSERT_EQ(z >> k, z / power_k) << k;
+        ASSERT_EQ(-z >> k, -((z - 1) / power_k) - 1) << k;
+        ASSERT_EQ(-(z * power_k) >> k, -z) << k;
+        for (const BigInt& value : {z, -z, z * power_k, -(z * power_k)}) {
+            ASSERT_EQ(value.test_bit(k), ((value >> k) & 1) != 0) << k;
+            ASSERT_EQ(value.test_bit(k + 1), ((value >> (k + 1)) & 1) != 0) << k;
+        }
+        ASSERT_EQ((-(z * power_k)).trailing_zeros(), k + z.trailing_zeros()) << k;
+    }
+    ASSERT_EQ(x & (power - 1), x - ((x >> 300) << 300));
+    ASSERT_EQ((-x | power) ^ power, -x);
+    ASSERT_EQ(x ^ x, 0);
+    ASSERT_EQ(x & ~x, 0);
+    ASSERT_EQ(x | ~x, -1);
+    ASSERT_TRUE(x.test_bit(5000));
+    ASSERT_FALSE((-x).test_bit(5000));
+
+    BigInt y = x;
+    y <<= 64;
+    y >>= 64;
+    ASSERT_EQ(y, x);
+    y &= power - 1;
+    y |= power;
+    y ^= power;
+    ASSERT_EQ(y, x & (power - 1));
+}
+
+TEST(CopyOnWrite, Test21) {
+    const BigInt original = pow(BigInt(3), 20000);
+    const std::string digits = BigInt::to_string(original);
+    std::vector<BigInt> copies(8, original);
+    copies[0] += 1;
+    copies[1] <<= 3;
+    copies[2] = -copies[2];
+    ++copies[3];
+    ASSERT_EQ(BigInt::to_string(original), digits);
+    ASSERT_EQ(copies[0] - 1, original);
+    ASSERT_EQ(copies[1] >> 3, original);
+    ASSERT_EQ(-copies[2], original);
+    ASSERT_EQ(copies[7], original);
+
+    // Copies of one value are mutated concurrently; each must see its own limbs.
+    std::vector<std::thread> threads;
+    std::vector<BigInt> results(copies.size());
+    for (std::size_t t = 0; t < copies.size(); ++t) {
+        threads.emplace_back([&original, &results, t]() {
+            BigInt value = original;
+            for (int i = 0; i < 100; ++i) {
+                BigInt snapshot = value;
+                value += static_cast<int64_t>(t);
+                ASSERT_EQ(value - snapshot, static_cast<int64_t>(t));
+            }
+            results[t] = value;
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (std::size_t t = 0; t < copies.size(); ++t) {
+        ASSERT_EQ(results[t], original + static_cast<int64_t>(100 * t));
+    }
+    ASSERT_EQ(BigInt::to_string(original), digits);
+}
+
+TEST(FormulaEngine, Test22) {
+    FormulaEngine engine;
+    engine.assign("a", "10");
+    engine.assign("b", "a * a");
+    engine.assign("c", "b - a");
+    engine.assign("d", "b % 7");
+    engine.assign("e", "(c + d) * 2");
+    ASSERT_TRUE(engine.isStale("e"));
+    ASSERT_EQ(engine.evaluations(), 0u);
+    ASSERT_EQ(engine.value("e"), 184);
+    ASSERT_EQ(engine.evaluations(), 5u);
+    ASSERT_EQ(engine.value("e"), 184);
+    ASSERT_EQ(engine.evaluations(), 5u);
+
+    // Only the downstream formulas of a changed input are recomputed, and only on demand.
+    engine.assign("unrelated", "123456789 * 987654321");
+    engine.assign("a", "11");
+    ASSERT_TRUE(engine.isStale("b"));
+    ASSERT_TRUE(engine.isStale("e"));
+    ASSERT_EQ(engine.evaluations(), 5u);
+    ASSERT_EQ(engine.value("b"), 121);
+    ASSERT_EQ(engine.evaluations(), 7u);
+    ASSERT_TRUE(engine.isStale("e"));
+    ASSERT_EQ(engine.value("e"), 2 * (110 + 2));
+    ASSERT_EQ(engine.evaluations(), 10u);
+
+    // An edit that leaves a value unchanged stops propagating there.
+    engine.assign("a", "22 / 2");
+    ASSERT_EQ(engine.value("e"), 224);
+    ASSERT_EQ(engine.evaluations(), 11u);
+    engine.assign("a", "-11");
+    engine.value("d");
+    ASSERT_EQ(engine.evaluations(), 13u);
+    ASSERT_EQ(engine.value("e"), 2 * (121 + 11 + 2));
+    ASSERT_EQ(engine.evaluations(), 15u);
+
+    ASSERT_EQ(engine.evaluate("e - c * 2"), 4);
+    ASSERT_EQ(engine.dependencies("e"), (std::vector<std::string>{"c", "d"}));
+    ASSERT_EQ(engine.dependents("b"), (std::vector<std::string>{"c", "d"}));
+
+    ASSERT_THROW(engine.assign("a", "e + 1"), std::invalid_argument);
+    ASSERT_THROW(engine.assign("f", "f"), std::invalid_argument);
+    ASSERT_THROW(engine.assign("1x", "2"), std::invalid_argument);
+    ASSERT_THROW(engine.assign("g", "(1 + 2"), std::invalid_argument);
+    ASSERT_THROW(engine.assign("g", "1 $ 2"), std::invalid_argument);
+    ASSERT_EQ(engine.value("a"), -11);
+
+    // Formulas may refer to variables that are defined later.
+    engine.assign("h", "later + 1");
+    ASSERT_THROW(engine.value("h"), std::out_of_range);
+    engine.assign("later", "41");
+    ASSERT_EQ(engine.value("h"), 42);
+    engine.assign("zero", "0");
+    engine.assign("q", "h / zero");
+    ASSERT_THROW(engine.value("q"), std::domain_error);
+
+    std::string name, expression;
+    ASSERT_TRUE(FormulaEngine::parseAssignment("  total = a + b", &name, &expression));
+    ASSERT_EQ(name, "total");
+    ASSERT_EQ(expression, " a + b");
+    ASSERT_FALSE(FormulaEngine::parseAssignment("a + b", &name, &expression));
+}
+
+TEST(Budget, Test23) {
+    EvaluationBudget budget;
+    budget.max_operand_digits = 30;
+    budget.max_result_digits = 50;
+    const auto no_variables = [](const std::string&) -> BigInt { return 0; };
+    ASSERT_EQ(evaluateRPN({"123456789012345678901234567890", "2", "*"}, no_variables, budget),
+              BigInt("246913578024691357802469135780"));
+    ASSERT_THROW(evaluateRPN({"1234567890123456789012345678901", "1", "+"}, no_variables, budget),
+                 EvaluationAborted);
+    // The product would have about 60 digits: rejected before multiplying.
+    ASSERT_THROW(evaluateRPN({"123456789012345678901234567890", "123456789012345678901234567890",
+                              "*"},
+                             no_variables, budget),
+                 EvaluationAborted);
+
+    FormulaEngine engine;
+    engine.setBudget(budget);
+    engine.assign("a", "10000000000000000000");
+    engine.assign("b", "a * a");
+    engine.assign("c", "b * a");
+    ASSERT_EQ(engine.value("b"), BigInt("1" + std::string(38, '0')));
+    ASSERT_THROW(engine.value("c"), EvaluationAborted);
+    ASSERT_TRUE(engine.isStale("c"));
+    engine.setBudget(EvaluationBudget());
+    ASSERT_EQ(engine.value("c"), BigInt("1" + std::string(57, '0')));
+
+    // Deadlines and cancellation interrupt long multiplications and divisions.
+    const BigInt x = pow(BigInt(7), 200000);
+    const BigInt y = pow(BigInt(3), 150000);
+    EvaluationBudget timed;
+    timed.time_limit = std::chrono::milliseconds(1);
+    {
+        const BudgetScope scope(timed);
+        ASSERT_THROW(x * y, EvaluationAborted);
+        ASSERT_THROW(x / y, EvaluationAborted);
+    }
+    ASSERT_EQ(BudgetScope::current(), nullptr);
+    // A limit past the clock's range saturates; an inner short one still applies.
+    EvaluationBudget forever;
+    forever.time_limit = std::chrono::milliseconds::max();
+    {
+        const BudgetScope outer(forever);
+        ASSERT_EQ(BigInt(7) * 6, 42);
+        const BudgetScope inner(timed);
+        ASSERT_THROW(x * y, EvaluationAborted);
+    }
+
+    CancellationToken token;
+    EvaluationBudget cancellable;
+    cancellable.cancellation = &token;
+    std::thread canceller([&token]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        token.cancel();
+    });
+    const auto start = std::chrono::steady_clock::now();
+    {
+        const BudgetScope scope(cancellable);
+        ASSERT_THROW(x / (y + 1), EvaluationAborted);
+    }
+    canceller.join();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+    token.reset();
+    {
+        const BudgetScope scope(cancellable);
+        ASSERT_EQ(BigInt(6) * 7, 42);
+    }
+}
+
+TEST(Tuning, Test24) {
+    const TuningProfile saved = TuningProfile::active();
+    TuningProfile profile;
+    profile.karatsuba_base_case = 8;
+    profile.schoolbook_limbs = 5;
+    profile.ntt_limbs = 9;
+    profile.ntt_min_limbs = 4;
+    profile.binary_division_limbs = 3;
+    profile.binary_division_ratio = 2;
+    const TuningProfile parsed = TuningProfile::parse(profile.toString());
+    ASSERT_EQ(parsed.karatsuba_base_case, 8);
+    ASSERT_EQ(parsed.schoolbook_limbs, 5);
+    ASSERT_EQ(parsed.ntt_limbs, 9);
+    ASSERT_EQ(parsed.ntt_min_limbs, 4);
+    ASSERT_EQ(parsed.binary_division_limbs, 3);
+    ASSERT_EQ(parsed.binary_division_ratio, 2);
+    ASSERT_EQ(TuningProfile::parse("# comment\n\nschoolbook_limbs 7\n").schoolbook_limbs, 7);
+    ASSERT_THROW(TuningProfile::parse("schoolbook_limbs"), std::invalid_argument);
+    ASSERT_THROW(TuningProfile::parse("schoolbook_limbs -1"), std::invalid_argument);
+    ASSERT_THROW(TuningProfile::parse("karatsuba_base_case 0"), std::invalid_argument);
+    ASSERT_EQ(TuningProfile::parse("karatsuba_base_case 1").karatsuba_base_case, 1);
+    ASSERT_THROW(TuningProfile::parse("fft_limbs 100"), std::invalid_argument);
+    ASSERT_THROW(TuningProfile::load("/nonexistent/big_int_tuning.txt"), std::runtime_error);
+
+    BigInt a("-98765432109876543210987654321098765432109876543210987654321098765432109876543210");
+    a *= a;
+    BigInt b("12345678901234567890123456789012345678901234567");
+    std::vector<BigInt> products, quotients, remainders;
+    for (int limbs : {0, 1, 4, 1000}) {
+        profile.schoolbook_limbs = limbs;
+        profile.binary_division_limbs = limbs;
+        profile.binary_division_ratio = limbs % 3;
+        profile.karatsuba_base_case = limbs % 7 + 1;
+        TuningProfile::setActive(profile);
+        products.push_back(a * b);
+        quotients.push_back(a / b);
+        remainders.push_back(a % b);
+    }
+    TuningProfile::setActive(saved);
+    for (std::size_t i = 1; i < products.size(); ++i) {
+        ASSERT_EQ(products[i], products[0]);
+        ASSERT_EQ(quotients[i], quotients[0]);
+        ASSERT_EQ(remainders[i], remainders[0]);
+    }
+    ASSERT_EQ(quotients[0] * b + remainders[0], a);
+    ASSERT_THROW(a / BigInt(0), std::domain_error);
+}
+
+TEST(PreparedMultiplier, Test25) {
+    const TuningProfile saved = TuningProfile::active();
+    TuningProfile profile = saved;
+    profile.karatsuba_base_case = 4;
+    profile.schoolbook_limbs = 2;
+    TuningProfile::setActive(profile);
+
+    BigInt fixed = -pow(BigInt(7), 700) + 12345;
+    const PreparedMultiplier prepared(fixed);
+    ASSERT_EQ(prepared.value(), fixed);
+    std::vector<BigInt> others = {0,
+                                  1,
+                                  -3,
+                                  BigInt("123456789123456789123456789"),
+                                  -pow(BigInt(3), 300),
+                                  pow(BigInt(10), 590) - 1,
+                                  pow(BigInt(11), 2000) + 1,
+                                  pow(BigInt(2), 9000) - pow(BigInt(5), 40)};
+    for (int round = 0; round < 2; ++round) {
+        for (const BigInt& other : others) {
+            ASSERT_EQ(prepared * other, fixed * other);
+            ASSERT_EQ(other * prepared, other * fixed);
+        }
+    }
+
+    std::vector<BigInt> products(4);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < products.size(); ++t) {
+        threads.emplace_back([&, t]() { products[t] = prepared.multiply(others[4 + t]); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    TuningProfile::setActive(saved);
+    for (std::size_t t = 0; t < products.size(); ++t) {
+        ASSERT_EQ(products[t], fixed * others[4 + t]);
+    }
+    ASSERT_EQ(PreparedMultiplier(pow(BigInt(10), 20000)).multiply(pow(BigInt(10), 15000)),
+              pow(BigInt(10), 35000));
+
+    // Cached transforms, with the prepared operand as the shorter and as the longer factor.
+    others.push_back(-pow(BigInt(3), 40000) + 1);
+    std::vector<BigInt> transformed;
+    profile = saved;
+    profile.ntt_limbs = 1;
+    profile.ntt_min_limbs = 1;
+    TuningProfile::setActive(profile);
+    for (int round = 0; round < 2; ++round) {
+        for (const BigInt& other : others) {
+            transformed.push_back(prepared * other);
+        }
+    }
+    TuningProfile::setActive(saved);
+    for (std::size_t i = 0; i < transformed.size(); ++i) {
+        ASSERT_EQ(transformed[i], fixed * others[i % others.size()]);
+    }
+}
+
+TEST(Rns, Test26) {
+    const auto basis = std::make_shared<const RnsBasis>(300);
+    ASSERT_GE(basis->product(), pow(BigInt(10), 300) * 2);
+    for (uint32_t p : basis->primes()) {
+        ASSERT_TRUE(p > (1u << 30) && p < (1u << 31) && is_probable_prime(p));
+    }
+
+    const BigInt a = pow(BigInt(3), 200) - 17;
+    const BigInt b = -pow(BigInt(7), 100) + 5;
+    const BigInt c("-123456789012345678901234567890");
+    RnsInteger x(basis, a), y(basis, b), z(basis, c);
+    ASSERT_EQ(x.toBigInt(), a);
+    ASSERT_EQ(y.toBigInt(), b);
+    ASSERT_EQ(RnsInteger(basis, 0).toBigInt(), 0);
+    ASSERT_EQ((x * y - z).toBigInt(), a * b - c);
+    ASSERT_EQ((x + y * z * z).toBigInt(), a + b * c * c);
+    ASSERT_EQ((-x * x + y).toBigInt(), -a * a + b);
+
+    // A chain whose intermediate values stay in range.
+    RnsInteger acc(basis, 1);
+    BigInt expected = 1;
+    for (int i = 1; i <= 150; ++i) {
+        acc *= RnsInteger(basis, i);
+        acc -= RnsInteger(basis, i * i);
+        expected = expected * i - i * i;
+    }
+    ASSERT_EQ(acc.toBigInt(), expected);
+
+    ASSERT_THROW(RnsInteger(basis, basis->product()), std::out_of_range);
+    const auto other = std::make_shared<const RnsBasis>(300);
+    ASSERT_THROW(x + RnsInteger(other, 1), std::invalid_argument);
+    ASSERT_EQ(RnsBasis(0).size(), 1u);
+}
+
+TEST(Service, Test27) {
+    ServiceOptions options;
+    options.workers = 3;
+    options.max_in_flight = 4;
+    CalculatorService service(options);
+
+    std::string requests, expected;
+    for (int i = 0; i < 40; ++i) {
+        requests += "(" + std::to_string(i) + " + 1) * 123456789123456789\n";
+        expected += BigInt::to_string(BigInt(i + 1) * BigInt("123456789123456789")) + "\n";
+    }
+    requests += "x = 2 * 3\n\nx * x + y\ny = x - 1\nx * y\n(1\n1 / 0\nx = x + 1\n";
+    expected +=
+        "Defined x\nError: Undefined variable 'y'\nDefined y\n30\n"
+        "Error: Mis-match in parentheses\nError: Division by zero\n"
+        "Error: Circular reference: 'x' depends on itself\n";
+    std::istringstream in(requests);
+    std::ostringstream out;
+    service.serve(in, out);
+    ASSERT_EQ(out.str(), expected);
+    ASSERT_EQ(service.handled(), 47u);
+
+    // Sessions do not share variables; file descriptors work like streams.
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    std::thread session([&]() { service.serve(fds[1], fds[1]); });
+    const std::string request = "x * 2\nz = 5\nz * 2\n";
+    ASSERT_EQ(write(fds[0], request.data(), request.size()), ssize_t(request.size()));
+    shutdown(fds[0], SHUT_WR);
+    session.join();
+    close(fds[1]);
+    std::string response;
+    char buffer[256];
+    for (ssize_t size; (size = read(fds[0], buffer, sizeof(buffer))) > 0;) {
+        response.append(buffer, size);
+    }
+    close(fds[0]);
+    ASSERT_EQ(response, "Error: Undefined variable 'x'\nDefined z\n10\n");
+}
+
+TEST(Division, Test28) {
+    // Long dividends by divisors of every size go through both division algorithms.
+    const TuningProfile saved = TuningProfile::active();
+    const BigInt a = -pow(BigInt(7), 30000) + 1;
+    const std::vector<BigInt> divisors = {BigInt(1234567), BigInt("123456789012345678"),
+                                          pow(BigInt(3), 500) + 1, -pow(BigInt(11), 8000) - 5,
+                                          pow(BigInt(13), 20000)};
+    TuningProfile profile = saved;
+    for (const BigInt& b : divisors) {
+        std::vector<std::pair<BigInt, BigInt>> results;
+        for (int ratio : {0, 1 << 20}) {
+            profile.binary_division_limbs = 0;
+            profile.binary_division_ratio = ratio;
+            TuningProfile::setActive(profile);
+            results.push_back(divmod(a, b));
+        }
+        TuningProfile::setActive(saved);
+        results.push_back(divmod(a, b));
+        for (const auto& result : results) {
+            ASSERT_EQ(result.first, results[0].first);
+            ASSERT_EQ(result.second, results[0].second);
+        }
+        ASSERT_EQ(results[0].first * b + results[0].second, a);
+        ASSERT_TRUE(results[0].second <= 0 && results[0].second.abs() < b.abs());
+    }
+}
+
+TEST(Service, Test29) {
+    char directory[] = "/tmp/big_int_service_XXXXXX";
+    ASSERT_NE(mkdtemp(directory), nullptr);
+    const std::string path = std::string(directory) + "/calculator.sock";
+    const std::string file = std::string(directory) + "/notes.txt";
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::copy(path.begin(), path.end(), address.sun_path);
+
+    CancellationToken token;
+    ServiceOptions options;
+    options.workers = 2;
+    options.budget.cancellation = &token;
+    CalculatorService service(options);
+
+    // A file that is not a socket is neither replaced nor removed.
+    std::ofstream(file) << "keep";
+    ASSERT_THROW(service.listen(file), std::runtime_error);
+    std::string contents;
+    std::ifstream(file) >> contents;
+    ASSERT_EQ(contents, "keep");
+
+    // A stale socket left by an earlier server is replaced.
+    const int stale = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_EQ(bind(stale, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+    close(stale);
+
+    std::thread server([&]() { service.listen(path); });
+    auto connectClient = [&]() {
+        const int client = socket(AF_UNIX, SOCK_STREAM, 0);
+        for (int attempt = 0; attempt < 500; ++attempt) {
+            if (connect(client, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) ==
+                0) {
+                return client;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        close(client);
+        return -1;
+    };
+    auto exchange = [](int client, const std::string& request) {
+        EXPECT_EQ(write(client, request.data(), request.size()), ssize_t(request.size()));
+        shutdown(client, SHUT_WR);
+        std::string response;
+        char buffer[256];
+        for (ssize_t size; (size = read(client, buffer, sizeof(buffer))) > 0;) {
+            response.append(buffer, size);
+        }
+        close(client);
+        return response;
+    };
+
+    // One session stays open while others come and go; each has its own variables.
+    const int idle = connectClient();
+    ASSERT_GE(idle, 0);
+    for (int i = 0; i < 3; ++i) {
+        const int client = connectClient();
+        ASSERT_GE(client, 0);
+        ASSERT_EQ(exchange(client, "x = " + std::to_string(i) + "\nx * 10\n"),
+                  "Defined x\n" + std::to_string(i * 10) + "\n");
+    }
+    ASSERT_EQ(exchange(idle, "x\n123456789 * 987654321\n"),
+              "Error: Undefined variable 'x'\n121932631112635269\n");
+
+    token.cancel();
+    server.join();
+    ASSERT_EQ(service.handled(), 8u);
+    ASSERT_NE(access(path.c_str(), F_OK), 0);
+    unlink(file.c_str());
+    ASSERT_EQ(rmdir(directory), 0);
+}
+
+TEST(Ntt, Test30) {
+    // Products by number-theoretic transforms against Karatsuba and schoolbook. The unbalanced
+    // ones cut the longer operand into chunks, down to four limbs for a one-limb factor.
+    const TuningProfile saved = TuningProfile::active();
+    const BigInt nines = pow(BigInt(10), 9 * 3000) - 1;  // every limb at its maximum
+    const std::vector<std::pair<BigInt, BigInt>> operands = {
+        {nines, nines},
+        {-pow(BigInt(7), 20000) + 1, pow(BigInt(3), 30000) - 7},
+        {pow(BigInt(13), 40000), BigInt(-987654321)},
+        {pow(BigInt(2), 100000) + 1, -pow(BigInt(5), 3000)},
+        {pow(BigInt(3), 200000) - 1, pow(BigInt(7), 9000) + 5},
+        {nines, pow(BigInt(10), 9 * 100) - 1},
+        {BigInt(0), nines}};
+    TuningProfile profile = saved;
+    for (const auto& pair : operands) {
+        std::vector<BigInt> products;
+        for (int ntt_limbs : {0, std::numeric_limits<int>::max()}) {
+            profile.schoolbook_limbs = 1;
+            profile.ntt_limbs = ntt_limbs;
+            profile.ntt_min_limbs = ntt_limbs;
+            TuningProfile::setActive(profile);
+            products.push_back(pair.first * pair.second);
+            products.push_back(pair.first * pair.first);
+        }
+        TuningProfile::setActive(saved);
+        ASSERT_EQ(products[0], products[2]);
+        ASSERT_EQ(products[1], products[3]);
+        BigInt schoolbook;
+        addmul(&schoolbook, pair.first, pair.second);
+        ASSERT_EQ(products[0], schoolbook);
+    }
+    ASSERT_EQ(nines * nines, pow(BigInt(10), 2 * 9 * 3000) - pow(BigInt(10), 9 * 3000) * 2 + 1);
+
+    const std::string digits = BigInt::to_string(factorial(100000));
+    ASSERT_EQ(digits.size(), 456574u);
+    ASSERT_EQ(digits.substr(0, 20), "28242294079603478742");
+}
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include "big_integer_lib/big_int.h"
+#include "big_integer_lib/tuning.h"
+
+/*
+    Measures the crossover thresholds of the dispatch on this machine and writes a tuning
+    profile: big_integer_tune [profile path, default big_int_tuning.txt].
+*/
+
+namespace {
+
+std::mt19937_64 generator(12345);
+
+BigInt randomNumber(int limbs) {
+    std::string digits(1, static_cast<char>('1' + generator() % 9));
+    while (static_cast<int>(digits.size()) < limbs * 9) {
+        digits += static_cast<char>('0' + generator() % 10);
+    }
+    return BigInt(digits);
+}
+
+// Best-of-several wall time of `operation` in seconds, repeated to at least ~2 ms per sample.
+template <typename Operation>
+double measure(const Operation& operation) {
+    int repetitions = 1;
+    double best = 0;
+    for (int sample = 0; sample < 5; ++sample) {
+        for (;;) {
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < repetitions; ++i) {
+                operation();
+            }
+            const double elapsed =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (elapsed < 0.002) {
+                repetitions *= 2;
+                continue;
+            }
+            best = sample == 0 ? elapsed / repetitions : std::min(best, elapsed / repetitions);
+            break;
+        }
+    }
+    return best;
+}
+
+template <typename Operation>
+double measureWith(const TuningProfile& profile, const Operation& operation) {
+    TuningProfile::setActive(profile);
+    return measure(operation);
+}
+
+// The Karatsuba leaf size with the fastest large multiplication.
+int tuneKaratsubaBaseCase(TuningProfile profile) {
+    const BigInt a = randomNumber(2000);
+    const BigInt b = randomNumber(2000);
+    profile.schoolbook_limbs = 0;
+    profile.ntt_limbs = std::numeric_limits<int>::max();
+    int best_size = profile.karatsuba_base_case;
+    double best_time = -1;
+    for (int size : {4, 8, 16, 32, 64, 128, 256}) {
+        profile.karatsuba_base_case = size;
+        const double time = measureWith(profile, [&]() { return a * b; });
+        std::cout << "  karatsuba_base_case " << size << ": " << time * 1e3 << " ms\n";
+        if (best_time < 0 || time < best_time) {
+            best_time = time;
+            best_size = size;
+        }
+    }
+    return best_size;
+}
+
+// The smallest balanced size at which repacking for Karatsuba beats direct schoolbook.
+int tuneSchoolbookLimbs(TuningProfile profile) {
+    const std::vector<int> sizes = {2,   4,   8,   12,  16,  24,  32,   48,  64,
+                                    96,  128, 192, 256, 384, 512, 768, 1024};
+    profile.ntt_limbs = std::numeric_limits<int>::max();
+    for (int size : sizes) {
+        const BigInt a = randomNumber(size);
+        const BigInt b = randomNumber(size);
+        profile.schoolbook_limbs = size + 1;
+        const double schoolbook = measureWith(profile, [&]() { return a * b; });
+        profile.schoolbook_limbs = 0;
+        const double karatsuba = measureWith(profile, [&]() { return a * b; });
+        std::cout << "  multiply " << size << " limbs: schoolbook " << schoolbook * 1e6
+                  << " us, karatsuba " << karatsuba * 1e6 << " us\n";
+        if (karatsuba < schoolbook) {
+            return size;
+        }
+    }
+    return sizes.back() + 1;
+}
+
+// The smallest balanced size from which number-theoretic transforms beat Karatsuba. Both pad
+// to powers of two, so each candidate is timed over sizes spread across [size, 1.5 size).
+// Sizes below schoolbook_limbs never reach either.
+int tuneNttLimbs(TuningProfile profile) {
+    const std::vector<int> sizes = {512, 768, 1024, 1536, 2048, 3072, 4096, 6144, 8192};
+    const int schoolbook_limbs = profile.schoolbook_limbs;
+    profile.schoolbook_limbs = 0;
+    profile.ntt_min_limbs = 0;
+    for (int size : sizes) {
+        if (size < schoolbook_limbs) {
+            continue;
+        }
+        double karatsuba = 0;
+        double ntt = 0;
+        for (int step = 0; step < 4; ++step) {
+            const BigInt a = randomNumber(size + size * step / 8);
+            const BigInt b = randomNumber(size + size * step / 8);
+            profile.ntt_limbs = std::numeric_limits<int>::max();
+            karatsuba += measureWith(profile, [&]() { return a * b; });
+            profile.ntt_limbs = 0;
+            ntt += measureWith(profile, [&]() { return a * b; });
+        }
+        std::cout << "  multiply " << size << " to " << size * 3 / 2 << " limbs: karatsuba "
+                  << karatsuba * 1e3 << " ms, ntt " << ntt * 1e3 << " ms\n";
+        if (ntt < karatsuba) {
+            return size;
+        }
+    }
+    return sizes.back() + 1;
+}
+
+// The smallest shorter operand from which number-theoretic transforms beat schoolbook on a
+// product with a much longer operand, cut into chunks by the transforms.
+int tuneNttMinLimbs(TuningProfile profile) {
+    const std::vector<int> sizes = {32, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048};
+    const int longer = std::max(65536, 16 * profile.ntt_limbs);
+    const BigInt a = randomNumber(longer);
+    for (int size : sizes) {
+        const BigInt b = randomNumber(size);
+        profile.schoolbook_limbs = std::numeric_limits<int>::max();
+        profile.ntt_limbs = std::numeric_limits<int>::max();
+        const double schoolbook = measureWith(profile, [&]() { return a * b; });
+        profile.ntt_limbs = 0;
+        profile.ntt_min_limbs = 0;
+        const double ntt = measureWith(profile, [&]() { return a * b; });
+        std::cout << "  multiply " << longer << " by " << size << " limbs: schoolbook "
+                  << schoolbook * 1e3 << " ms, ntt " << ntt * 1e3 << " ms\n";
+        if (ntt < schoolbook) {
+            return size;
+        }
+    }
+    return sizes.back() + 1;
+}
+
+// The smallest dividend size at which long division beats binary division by a one-limb
+// divisor, the case where the conversions to and from binary weigh most.
+int tuneBinaryDivisionLimbs(TuningProfile profile) {
+    const std::vector<int> sizes = {8, 16, 32, 48, 64, 96, 128, 192, 256, 384, 512};
+    const BigInt b = randomNumber(1);
+    profile.binary_division_ratio = 0;
+    for (int size : sizes) {
+        const BigInt a = randomNumber(size);
+        profile.binary_division_limbs = size + 1;
+        const double binary = measureWith(profile, [&]() { return a / b; });
+        profile.binary_division_limbs = 0;
+        const double decimal = measureWith(profile, [&]() { return a / b; });
+        std::cout << "  divide " << size << " by 1 limb: long division " << decimal * 1e6
+                  << " us, binary " << binary * 1e6 << " us\n";
+        if (decimal < binary) {
+            return size;
+        }
+    }
+    return sizes.back() + 1;
+}
+
+// The largest dividend-to-divisor size ratio at which binary division still beats long
+// division on a dividend too long for binary_division_limbs.
+int tuneBinaryDivisionRatio(TuningProfile profile) {
+    const int size = std::max(2048, 2 * profile.binary_division_limbs);
+    const BigInt a = randomNumber(size);
+    profile.binary_division_limbs = 0;
+    int best_ratio = 0;
+    for (int ratio : {2, 3, 4, 6, 8, 12, 16, 24, 32}) {
+        const int divisor_size = (size + ratio - 1) / ratio;
+        const BigInt b = randomNumber(divisor_size);
+        profile.binary_division_ratio = ratio;
+        const double binary = measureWith(profile, [&]() { return a / b; });
+        profile.binary_division_ratio = 0;
+        const double decimal = measureWith(profile, [&]() { return a / b; });
+        std::cout << "  divide " << size << " by " << divisor_size << " limbs: long division "
+                  << decimal * 1e3 << " ms, binary " << binary * 1e3 << " ms\n";
+        if (decimal < binary) {
+            break;
+        }
+        best_ratio = ratio;
+    }
+    return best_ratio;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const std::string path = argc > 1 ? argv[1] : "big_int_tuning.txt";
+    TuningProfile profile = TuningProfile::active();
+
+    std::cout << "Karatsuba base case:\n";
+    profile.karatsuba_base_case = tuneKaratsubaBaseCase(profile);
+    std::cout << "Schoolbook / Karatsuba crossover:\n";
+    profile.schoolbook_limbs = tuneSchoolbookLimbs(profile);
+    std::cout << "Karatsuba / NTT crossover:\n";
+    profile.ntt_limbs = tuneNttLimbs(profile);
+    std::cout << "Unbalanced schoolbook / NTT crossover:\n";
+    profile.ntt_min_limbs = tuneNttMinLimbs(profile);
+    std::cout << "Division crossover:\n";
+    profile.binary_division_limbs = tuneBinaryDivisionLimbs(profile);
+    profile.binary_division_ratio = tuneBinaryDivisionRatio(profile);
+
+    profile.save(path);
+    std::cout << "\nWrote " << path << ":\n" << profile.toString();
+    return 0;
+}